@@ -3,7 +3,7 @@
 void linear(int npart, int *pweights, int *new_mapp, int commsize) {
     int i, j, weight;
     
-    for (i = 0, j = 0; i < commsize; i++) {
+    for (i = 0, j = 0, weight = 0; i < commsize; i++) {
         if (weight >= pweights[j]) {
             j++;
             i--;
@@ -12,7 +12,6 @@ void linear(int npart, int *pweights, int *new_mapp, int commsize) {
         }
         new_mapp[i] = j;
         weight++;
-        printf("new_mapp[%d] = %d\n", i, j);
     }
 }
 
@@ -34,7 +33,6 @@ void rr(int npart, int *pweights, int *new_mapp, int commsize) {
         }
         new_mapp[i] = j;
         pweights_tmp[j]--;
-        printf("new_mapp[%d] = %d\n", i, j);
     }
     free(pweights_tmp);
 }
\ No newline at end of file
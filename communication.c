@@ -10,7 +10,8 @@
 
 struct comm {
     int nops;
-    uint64_t msgsize;
+    uint64_t sendsize;
+    uint64_t recvsize;
 };
 
 struct commtable {
@@ -39,7 +40,8 @@ commtable_t *commtable_create(int n)
     }
 
     for (i = 0; i < table->comm_size; i++) {
-        table->process[i].msgsize = 0;
+        table->process[i].sendsize = 0;
+        table->process[i].recvsize = 0;
         table->process[i].nops = 0;
     }
     
@@ -47,7 +49,7 @@ commtable_t *commtable_create(int n)
 }
 
 void commtable_add_datatype(int partner, int count, MPI_Datatype datatype,
-                   commtable_t *table)
+                            int direction, commtable_t *table)
 {
     int size;
     uint64_t msgsize;
@@ -55,18 +57,27 @@ void commtable_add_datatype(int partner, int count, MPI_Datatype datatype,
     MPI_Type_size(datatype, &size);
     msgsize = size * count;
     
-    table->process[partner].msgsize += msgsize;
-    table->process[partner].nops += 1;
+    commtable_add_msgsize(partner, msgsize, direction, table);
 }
 
-void commtable_add_msgsize(int partner, uint64_t msgsize, commtable_t *table)
+void commtable_add_msgsize(int partner, uint64_t msgsize, int direction,
+                           commtable_t *table)
 {
-    table->process[partner].msgsize += msgsize;
+    /* MPI_ANY_SOURCE, MPI_PROC_NULL */
+    if (partner < 0 || partner >= table->comm_size) {
+        return;
+    }
+    
+    if (direction == COMMTABLE_SEND) {
+        table->process[partner].sendsize += msgsize;
+    } else {
+        table->process[partner].recvsize += msgsize;
+    }
     table->process[partner].nops += 1;
 }
 
-int commtable_fill_vectors(commtable_t *table, int *vertices, uint64_t *weight,
-                           int *nedges)
+int commtable_fill_vectors(commtable_t *table, int *vertices, uint64_t *sendw,
+                           uint64_t *recvw, int *nedges)
 {
     int i = 0, j = 0;
     
@@ -76,9 +87,11 @@ int commtable_fill_vectors(commtable_t *table, int *vertices, uint64_t *weight,
     }
     
     for (i = 0, j = 0; i < table->comm_size; i++) {
-        if (table->process[i].msgsize != 0) {
+        if (table->process[i].sendsize != 0
+            || table->process[i].recvsize != 0) {
             vertices[j] = i+1;
-            weight[j] = table->process[i].msgsize;
+            sendw[j] = table->process[i].sendsize;
+            recvw[j] = table->process[i].recvsize;
             *nedges += 1;
             j++;
         }
@@ -91,7 +104,8 @@ void commtable_print(int rank, commtable_t *table)
 {
     int i = 0;
     for (i = 0; i < table->comm_size; i++) {
-        printf("%d\t--- %d\tsize = " "%" PRIu64 "\n", rank, i, table->process[i].msgsize);
+        printf("%d\t--- %d\tsend = %" PRIu64 "\trecv = %" PRIu64 "\n", rank, i,
+               table->process[i].sendsize, table->process[i].recvsize);
     }
 }
 
@@ -14,17 +14,24 @@
 
 #include <mpi.h>
 
+/* Direction of message relative to process owning the table */
+enum {
+    COMMTABLE_SEND = 0,
+    COMMTABLE_RECV = 1
+};
+
 typedef struct comm comm_t;
 typedef struct commtable commtable_t;
 
 commtable_t *commtable_create(int n);
 
-void commtable_add_msgsize(int partner, uint64_t msgsize, commtable_t *table);
+void commtable_add_msgsize(int partner, uint64_t msgsize, int direction,
+                           commtable_t *table);
 void commtable_add_datatype(int partner, int count, MPI_Datatype datatype,
-                            commtable_t *table);
+                            int direction, commtable_t *table);
 void commtable_print(int rank, commtable_t *table);
 void commtable_free(commtable_t *table);
-int commtable_fill_vectors(commtable_t *table, int *vertices, uint64_t *waight,
-                           int *nedges);
+int commtable_fill_vectors(commtable_t *table, int *vertices, uint64_t *sendw,
+                           uint64_t *recvw, int *nedges);
 
 #endif /*COMMUNICATION_H*/
@@ -0,0 +1,239 @@
+/*
+ * assign.c: Assignment of parts to nodes of network topology.
+ *
+ * Parts of partition are placed on nodes so that heavily communicating
+ * parts are close: parts are placed greedily in order of traffic to
+ * placed parts, each on free node of minimal cost, then pairs of parts
+ * exchange nodes while sum of traffic times distance decreases.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpart.h"
+#include "nettopo.h"
+
+#define ASSIGN_PASSES_MAX 8
+
+static long long assign_cost(const gpart_traffic_t *tr, const int *partnode,
+                             const gpart_nettopo_t *t, int p, int node,
+                             int skip);
+
+/* gpart_traffic_build: Build traffic between parts of partition. */
+gpart_traffic_t *gpart_traffic_build(csrgraph_t *g, const int *part,
+                                     int nparts)
+{
+	gpart_traffic_t *tr = NULL;
+	int *first = NULL, *order = NULL, *pos = NULL;
+	int err = 0, i, j, k, p, q, v, n, size;
+
+	if ( (tr = calloc(1, sizeof(*tr))) == NULL)
+		return NULL;
+	tr->nparts = nparts;
+	first = calloc(nparts + 1, sizeof(*first));
+	order = malloc(sizeof(*order) * (g->nvertices + 1));
+	pos = malloc(sizeof(*pos) * nparts);
+	tr->index = malloc(sizeof(*tr->index) * (nparts + 1));
+	if (first == NULL || order == NULL || pos == NULL || tr->index == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+
+	/* Vertices are sorted by parts (counting sort) */
+	for (v = 0; v < g->nvertices; v++) {
+		if (part[v] < 0 || part[v] >= nparts) {
+			err = 1;
+			goto errhandler;
+		}
+		first[part[v] + 1]++;
+	}
+	for (p = 0; p < nparts; p++)
+		first[p + 1] += first[p];
+	for (v = 0; v < g->nvertices; v++)
+		order[first[part[v]]++] = v;
+	for (p = nparts; p > 0; p--)
+		first[p] = first[p - 1];
+	first[0] = 0;
+
+	/* Two passes: count neighbour parts, then accumulate volumes */
+	for (k = 0; k < 2; k++) {
+		for (p = 0; p < nparts; p++)
+			pos[p] = -1;
+		for (p = 0, size = 0; p < nparts; p++) {
+			tr->index[p] = size;
+			for (i = first[p]; i < first[p + 1]; i++) {
+				v = order[i];
+				for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+					if ( (q = part[g->adjv[j]]) == p)
+						continue;
+					if (pos[q] < tr->index[p]) {
+						pos[q] = size++;
+						if (k > 0) {
+							tr->adjp[pos[q]] = q;
+							tr->volume[pos[q]] = 0;
+						}
+					}
+					if (k > 0)
+						tr->volume[pos[q]] += g->edges[j];
+				}
+			}
+		}
+		tr->index[nparts] = size;
+		if (k == 0) {
+			n = size > 0 ? size : 1;
+			tr->adjp = malloc(sizeof(*tr->adjp) * n);
+			tr->volume = malloc(sizeof(*tr->volume) * n);
+			if (tr->adjp == NULL || tr->volume == NULL) {
+				err = 1;
+				goto errhandler;
+			}
+		}
+	}
+
+errhandler:
+	free(first);
+	free(order);
+	free(pos);
+	if (err) {
+		gpart_traffic_free(tr);
+		return NULL;
+	}
+	return tr;
+}
+
+/* gpart_traffic_free: Destroy traffic between parts. */
+void gpart_traffic_free(gpart_traffic_t *tr)
+{
+	if (tr == NULL)
+		return;
+	free(tr->index);
+	free(tr->adjp);
+	free(tr->volume);
+	free(tr);
+}
+
+/* gpart_assign_nodes: Greedy placement of parts and pairwise swaps. */
+int gpart_assign_nodes(csrgraph_t *g, const int *part, int nparts,
+                       const int *partweights, const gpart_nettopo_t *t,
+                       int *partnode)
+{
+	gpart_traffic_t *tr = NULL;
+	long long *conn = NULL, *total = NULL, *central = NULL;
+	long long cost, bestcost, gain;
+	int *nodepart = NULL;
+	int err = 0, i, j, p, q, a, b, na, nb, best, pass, nswaps;
+
+	if (nparts > t->nnodes)
+		return 1;
+	if ( (tr = gpart_traffic_build(g, part, nparts)) == NULL)
+		return 1;
+	conn = calloc(nparts, sizeof(*conn));
+	total = calloc(nparts, sizeof(*total));
+	central = calloc(nparts, sizeof(*central));
+	nodepart = malloc(sizeof(*nodepart) * nparts);
+	if (conn == NULL || total == NULL || central == NULL || nodepart == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+
+	/* Central nodes are preferred when costs are equal */
+	for (i = 0; i < nparts; i++) {
+		nodepart[i] = -1;
+		partnode[i] = -1;
+		for (j = 0; j < nparts; j++)
+			central[i] += gpart_nettopo_distance(t, i, j);
+		for (j = tr->index[i]; j < tr->index[i + 1]; j++)
+			total[i] += tr->volume[j];
+	}
+
+	/*
+	 * Greedy placement: next part has maximal traffic to placed parts
+	 * (maximal total traffic first), node of part has minimal cost among
+	 * free nodes with the same number of slots.
+	 */
+	for (i = 0; i < nparts; i++) {
+		for (q = 0, p = -1; q < nparts; q++) {
+			if (partnode[q] >= 0)
+				continue;
+			if (p < 0 || conn[q] > conn[p]
+			    || (conn[q] == conn[p] && total[q] > total[p]))
+			{
+				p = q;
+			}
+		}
+		for (j = 0, best = -1, bestcost = 0; j < nparts; j++) {
+			if (nodepart[j] >= 0 || partweights[j] != partweights[p])
+				continue;
+			cost = assign_cost(tr, partnode, t, p, j, -1);
+			if (best < 0 || cost < bestcost
+			    || (cost == bestcost && central[j] < central[best]))
+			{
+				best = j;
+				bestcost = cost;
+			}
+		}
+		if (best < 0) {
+			err = 1;
+			goto errhandler;
+		}
+		partnode[p] = best;
+		nodepart[best] = p;
+		for (j = tr->index[p]; j < tr->index[p + 1]; j++)
+			conn[tr->adjp[j]] += tr->volume[j];
+	}
+
+	/* Parts exchange nodes while cost decreases */
+	for (pass = 0; pass < ASSIGN_PASSES_MAX; pass++) {
+		for (a = 0, nswaps = 0; a < nparts; a++) {
+			if (total[a] == 0)
+				continue;
+			for (b = 0; b < nparts; b++) {
+				if (b == a || partweights[b] != partweights[a])
+					continue;
+				na = partnode[a];
+				nb = partnode[b];
+				gain = assign_cost(tr, partnode, t, a, na, b)
+				       - assign_cost(tr, partnode, t, a, nb, b)
+				       + assign_cost(tr, partnode, t, b, nb, a)
+				       - assign_cost(tr, partnode, t, b, na, a);
+				if (gain > 0) {
+					partnode[a] = nb;
+					partnode[b] = na;
+					nswaps++;
+				}
+			}
+		}
+		if (nswaps == 0)
+			break;
+	}
+
+errhandler:
+	gpart_traffic_free(tr);
+	free(conn);
+	free(total);
+	free(central);
+	free(nodepart);
+	return err;
+}
+
+/*
+ * assign_cost: Return traffic times distance between part p placed on node
+ *              and placed parts except part skip.
+ */
+static long long assign_cost(const gpart_traffic_t *tr, const int *partnode,
+                             const gpart_nettopo_t *t, int p, int node,
+                             int skip)
+{
+	long long cost = 0;
+	int j, q;
+
+	for (j = tr->index[p]; j < tr->index[p + 1]; j++) {
+		q = tr->adjp[j];
+		if (q != skip && partnode[q] >= 0) {
+			cost += tr->volume[j]
+			        * gpart_nettopo_distance(t, node, partnode[q]);
+		}
+	}
+	return cost;
+}
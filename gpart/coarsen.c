@@ -33,6 +33,11 @@ static coarse_graph_t *create_coarse_graph_regular(coarse_graph_t *g,
 
 static int counting_sort(int *src, int *values, int n, int valmax, int *dst);
 
+/* Vertices fixed in different halves of bisection are not matched */
+#define COARSEN_COMPATIBLE(graph, v, u) ((graph)->vfixed == NULL \
+		|| (graph)->vfixed[v] == -1 || (graph)->vfixed[u] == -1 \
+		|| (graph)->vfixed[v] == (graph)->vfixed[u])
+
 /*
  * gpart_coarsen_graph:
  *
@@ -265,7 +270,8 @@ coarse_graph_t *coarsen_hem(coarse_graph_t *g, gpart_options_t *opt)
 			{
 				k = traverse[j];
 				if (match[k] == -1
-					&& (adjindexes[k] < adjindexes[k + 1]))
+					&& (adjindexes[k] < adjindexes[k + 1])
+					&& COARSEN_COMPATIBLE(graph, v, k))
 				{
 					vmax = k;
 					break;
@@ -296,7 +302,8 @@ coarse_graph_t *coarsen_hem(coarse_graph_t *g, gpart_options_t *opt)
 				k = graph->adjv[j];
 				if (match[k] == -1 && wmax < graph->edges[j]
 				    &&  (graph->vweights[v] + graph->vweights[k])
-				        <= opt->vweight_max)
+				        <= opt->vweight_max
+				    && COARSEN_COMPATIBLE(graph, v, k))
 				{
 					vmax = k;
 					wmax = graph->edges[j];
@@ -500,6 +507,13 @@ coarse_graph_t *create_coarse_graph(coarse_graph_t *g, int coarse_nvertices,
 		err = 1;
 		goto errhandler;
 	}
+	if (graph->vfixed != NULL) {
+		cggraph->vfixed = malloc(sizeof(*cggraph->vfixed) * coarse_nvertices);
+		if (cggraph->vfixed == NULL) {
+			err = 1;
+			goto errhandler;
+		}
+	}
 
 	/* Construct coarse graph */
 	for (i = 0; i < coarse_nvertices; i++)
@@ -514,6 +528,13 @@ coarse_graph_t *create_coarse_graph(coarse_graph_t *g, int coarse_nvertices,
 
 		cggraph->vweights[coarse_nvertices] = graph->vweights[v];
 
+		/* Multivertex is fixed if one of its vertices is fixed */
+		if (graph->vfixed != NULL) {
+			cggraph->vfixed[coarse_nvertices] = graph->vfixed[v] != -1
+			                                    ? graph->vfixed[v]
+			                                    : graph->vfixed[match[v]];
+		}
+
 		nedges = 0;
 		for (j = adjindexes[v]; j < adjindexes[v + 1];
 			 j++)
@@ -827,6 +848,46 @@ int gpart_project_bisection_regular(coarse_graph_t *cg, csrgraph_t *srcgraph,
 	return 0;
 }
 
+/*
+ * gpart_project_bisection_hierarchy: Project bisection of coarsest graph to
+ *                                    source graph and refine it. Coarse
+ *                                    graphs are kept.
+ *                                    Return 0 on success and 1 otherwise.
+ */
+int gpart_project_bisection_hierarchy(coarse_graph_t *cg, csrgraph_t *srcgraph,
+		                              int *bisection, int *partsizes)
+{
+	int i;
+	int *bisection_coarse = NULL;
+	int coarse_nvertices;
+	edgecut_t edgecut;
+
+	if (cg->prev == NULL)
+		return 0;
+
+	bisection_coarse = malloc(sizeof(*bisection_coarse) * srcgraph->nvertices);
+	if (bisection_coarse == NULL)
+		return 1;
+
+	coarse_nvertices = cg->graph->nvertices;
+	for (cg = cg->prev; cg != NULL; cg = cg->prev) {
+
+		for (i = 0; i < coarse_nvertices; i++)
+			bisection_coarse[i] = bisection[i];
+
+		/* Project bisection and refine */
+		for (i = 0; i < cg->graph->nvertices; i++)
+			bisection[i] = bisection_coarse[cg->graph->vmap[i]];
+
+		gpart_refine_bisection_fm(cg->graph, bisection, partsizes, &edgecut);
+
+		coarse_nvertices = cg->graph->nvertices;
+	}
+
+	free(bisection_coarse);
+	return 0;
+}
+
 /* counting_sort: Counting sort of items in src array by values. */
 int counting_sort(int *src, int *values, int n, int valmax, int *dst)
 {
@@ -26,6 +26,16 @@ struct coarse_graph {
 	coarse_graph_t *next;		/* Pointer to coarse graph */
 };
 
+struct gpart_hierarchy {
+	coarse_graph_t *head;		/* Source graph */
+	coarse_graph_t *coarsest;	/* Last in list */
+	int nlevels;				/* Number of coarse graphs */
+	unsigned long long hash;	/* Hash of source graph */
+};
+
+/* gpart_default_options: Setup coarsening options for graph g. */
+void gpart_default_options(csrgraph_t *g, gpart_options_t *opt);
+
 /*
  * gpart_coarsen_graph:
  *
@@ -67,6 +77,15 @@ int gpart_project_bisection_regular(coarse_graph_t *cg, csrgraph_t *srcgraph,
 		                            int *bisection, gpart_options_t *opt,
 		                            int *partsizes);
 
+/*
+ * gpart_project_bisection_hierarchy: Project bisection of coarsest graph to
+ *                                    source graph and refine it. Coarse
+ *                                    graphs are kept.
+ *                                    Return 0 on success and 1 otherwise.
+ */
+int gpart_project_bisection_hierarchy(coarse_graph_t *cg, csrgraph_t *srcgraph,
+		                              int *bisection, int *partsizes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,74 @@
+/*
+ * csrbin.h: Binary CSR graph format.
+ *
+ * File consists of header and arrays; every array starts at offset aligned
+ * to CSRBIN_ALIGN bytes, so file can be mapped into memory and arrays used
+ * without copying. Byte order is native.
+ *
+ *   adjindexes  int32_t[nvertices + 1]
+ *   adjv        int32_t[nadj]        (0-based)
+ *   echannel 0  int32_t[nadj]        (edge weights, csrgraph_t edges)
+ *   echannel i  uint64_t[nadj]       (i = 1: bytes sent, i = 2: received)
+ *   vchannel i  int64_t[nvertices]   (vertex weights: i = 0: compute time of
+ *                                     process in microseconds, i = 1: its
+ *                                     peak resident set size in KB)
+ *   nodemap     int32_t[nvertices]   (node of vertex in profiled job, if
+ *                                     nnodes > 0; nodes are numbered in
+ *                                     order of their lowest rank)
+ *
+ * Unused offsets are 0.
+ */
+
+#ifndef CSRBIN_H
+#define CSRBIN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSRBIN_MAGIC          "GPARTCSR"
+#define CSRBIN_MAGIC_LEN      8
+#define CSRBIN_VERSION        1
+#define CSRBIN_ALIGN          64
+#define CSRBIN_ECHANNELS_MAX  4
+#define CSRBIN_VCHANNELS_MAX  4
+
+#define CSRBIN_ALIGNUP(x) \
+	(((x) + CSRBIN_ALIGN - 1) / CSRBIN_ALIGN * CSRBIN_ALIGN)
+
+enum {
+	CSRBIN_ECHANNEL_WEIGHT = 0,
+	CSRBIN_ECHANNEL_SEND = 1,
+	CSRBIN_ECHANNEL_RECV = 2
+};
+
+enum {
+	CSRBIN_VCHANNEL_COMPUTE = 0,
+	CSRBIN_VCHANNEL_RSS = 1
+};
+
+typedef struct csrbin_header csrbin_header_t;
+struct csrbin_header {
+	char magic[CSRBIN_MAGIC_LEN];
+	uint32_t version;
+	uint32_t headersize;
+	uint32_t nvertices;
+	uint32_t nnodes;				/* Number of nodes in nodemap or 0 */
+	uint64_t nadj;					/* Length of adjv: 2 * number of edges */
+	uint32_t nechannels;			/* Number of edge weight channels */
+	uint32_t nvchannels;			/* Number of vertex weight channels */
+	uint64_t off_adjindexes;
+	uint64_t off_adjv;
+	uint64_t off_echannels[CSRBIN_ECHANNELS_MAX];
+	uint64_t off_vchannels[CSRBIN_VCHANNELS_MAX];
+	uint64_t off_nodemap;
+	uint64_t filesize;
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSRBIN_H */
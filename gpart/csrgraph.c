@@ -9,14 +9,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "gpart.h"
+#include "csrbin.h"
+#include "csrzip.h"
 
 #define SETERR(v, n) v |= (1 << n)
 
 enum {
-	LINESIZE_MAX = 64 * 1024
+	LINESIZE_INIT = 64 * 1024
 };
 
 struct csrgraph_adjvertex {
@@ -24,6 +32,19 @@ struct csrgraph_adjvertex {
 };
 
 static int csrgraph_adjvertex_cmp(const void *a, const void *b);
+static csrgraph_t *csrgraph_load_bin(const char *filename);
+static int csrgraph_load_vchannels(csrgraph_t *graph, const char *filename);
+static int csrgraph_write_at(FILE *fout, uint64_t offset, const void *data,
+                             size_t size);
+static char *csrgraph_readline(FILE *fin, char **buf, size_t *bufsize);
+
+typedef int (*csrgraph_adjfunc_t)(int v, const void *arg,
+                                  struct csrgraph_adjvertex *adj);
+static csrgraph_t *csrgraph_generate(int nvertices, int degmax,
+                                     csrgraph_adjfunc_t adjfunc,
+                                     const void *arg);
+static int csrgraph_adjlist_normalize(int v, struct csrgraph_adjvertex *adj,
+                                      int deg);
 
 /* csrgraph_create: Allocate memory for graph. */
 csrgraph_t *csrgraph_create(int nvertices, int nedges)
@@ -38,6 +59,13 @@ csrgraph_t *csrgraph_create(int nvertices, int nedges)
 	graph->vparents = NULL;
 	graph->vweights = NULL;
 	graph->vmap = NULL;
+	graph->vfixed = NULL;
+	graph->nvchannels = 0;
+	memset(graph->vchannels, 0, sizeof(graph->vchannels));
+	graph->nnodes = 0;
+	graph->nodemap = NULL;
+	graph->mapaddr = NULL;
+	graph->maplen = 0;
 
 	graph->nvertices = nvertices;
 	graph->nedges = nedges;
@@ -76,50 +104,81 @@ errhandler:
 	return graph;
 }
 
-/* csrgraph_load: Read graph in CSR format from file. */
+/*
+ * csrgraph_load: Read graph in CSR format from file.
+ *                Binary files (see csrbin.h) are mapped into memory.
+ */
 csrgraph_t *csrgraph_load(const char *filename)
 {
 	int err = 0;
 	FILE *fin = NULL;
 	csrgraph_t *graph = NULL;
-	char *line = NULL, *buf = NULL, *ptr = NULL;
+	char magic[CSRBIN_MAGIC_LEN];
+	char *buf = NULL, *ptr = NULL, *p;
+	size_t bufsize = LINESIZE_INIT, len;
 	int i, j, v, w;
-	
-	fprintf(stderr,"load graph step 1\n");
+
 	if ( (fin = fopen(filename, "r")) == NULL) {
-	        fprintf(stderr, "Cant' load graph file\n");
+		fprintf(stderr, "Cant' load graph file\n");
 		SETERR(err, 1);
 		goto errhandler;
 	}
-	fprintf(stderr,"load graph step 2\n");
+
+	if (fread(magic, 1, CSRBIN_MAGIC_LEN, fin) == CSRBIN_MAGIC_LEN) {
+		if (memcmp(magic, CSRBIN_MAGIC, CSRBIN_MAGIC_LEN) == 0) {
+			fclose(fin);
+			return csrgraph_load_bin(filename);
+		}
+		if (memcmp(magic, CSRZIP_MAGIC, CSRZIP_MAGIC_LEN) == 0) {
+			fclose(fin);
+			return csrgraph_load_zip(filename);
+		}
+	}
+	rewind(fin);
+
 	if ( (graph = malloc(sizeof(*graph))) == NULL) {
 		SETERR(err, 1);
 		goto errhandler;
 	}
+	graph->adjindexes = NULL;
+	graph->adjv = NULL;
+	graph->edges = NULL;
 	graph->vparents = NULL;
 	graph->vweights = NULL;
 	graph->vmap = NULL;
-        fprintf(stderr,"load graph step 3\n");
+	graph->vfixed = NULL;
+	graph->nvchannels = 0;
+	memset(graph->vchannels, 0, sizeof(graph->vchannels));
+	graph->nnodes = 0;
+	graph->nodemap = NULL;
+	graph->mapaddr = NULL;
+	graph->maplen = 0;
 
-	if ( (buf = malloc(sizeof(*buf) * LINESIZE_MAX)) == NULL) {
+	if ( (buf = malloc(sizeof(*buf) * bufsize)) == NULL) {
 		SETERR(err, 1);
 		goto errhandler;
 	}
-	fprintf(stderr,"load graph step 4\n");
-	if (fscanf(fin, "%d %d %d\n", &graph->nvertices, 
-		                          &graph->nedges, &i) != 3) 
+	if (csrgraph_readline(fin, &buf, &bufsize) == NULL
+	    || sscanf(buf, "%d %d %d", &graph->nvertices, &graph->nedges, &i) != 3)
 	{
 		SETERR(err, 1);
 		goto errhandler;
 	}
-        fprintf(stderr,"load graph step 5\n");
+	if (graph->nvertices < 0 || graph->nvertices == INT_MAX
+	    || graph->nedges < 0 || graph->nedges > INT_MAX / 2)
+	{
+		fprintf(stderr, "Invalid graph file %s\n", filename);
+		SETERR(err, 1);
+		goto errhandler;
+	}
+
 	/* Allocate memory for graph */
 	graph->adjindexes = malloc(sizeof(int) * (graph->nvertices + 1));
 	if (graph->adjindexes == NULL) {
 		SETERR(err, 1);
 		goto errhandler;
 	}
-	fprintf(stderr,"load graph step 6\n");
+
 	/* Allocate memory for weights of edges */
 	graph->nedges *= 2;
 	graph->edges = malloc(sizeof(int) * graph->nedges);
@@ -127,66 +186,82 @@ csrgraph_t *csrgraph_load(const char *filename)
 		SETERR(err, 1);
 		goto errhandler;
 	}
-	fprintf(stderr,"load graph step 7\n");
+
 	graph->adjv = malloc(sizeof(int) * graph->nedges);
 	if (graph->adjv == NULL) {
 		SETERR(err, 1);
 		goto errhandler;
 	}
-	fprintf(stderr,"load graph step 8\n");
+
 	for (i = 0, j = 0; i < graph->nvertices; i++) {
-		
-		if (fgets(buf, LINESIZE_MAX, fin) == NULL) {
+		if (csrgraph_readline(fin, &buf, &bufsize) == NULL) {
 			SETERR(err, 1);
 			goto errhandler;
 		}
+		len = strlen(buf);
+		if (len > 0 && buf[len - 1] == '\n')
+			buf[len - 1] = '\0';
+
+		/* Read adj. list of vertex i */
+		graph->adjindexes[i] = j;
+		for (p = buf; ; ) {
+			while (*p == ' ' || *p == '\t' || *p == '\r')
+				p++;
+			if (*p == '\0')
+				break;
+			if (j >= graph->nedges) {
+				SETERR(err, 1);
+				goto errhandler;
+			}
+
+			errno = 0;
+			v = (int)strtol(p, &ptr, 10);
+			if (errno != 0 || ptr == p) {
+				SETERR(err, 1);
+				goto errhandler;
+			}
+			p = ptr;
+
+			errno = 0;
+			w = strtol(p, &ptr, 10);
+			if (errno != 0 || ptr == p) {
+				SETERR(err, 1);
+				goto errhandler;
+			}
+			p = ptr;
 
-		buf[strlen(buf) - 1] = '\0';
-		if (strlen(buf) > 0) {
-			line = buf;
-			
-			/* Read adj. list of vertex i */
-			graph->adjindexes[i] = j;
-			do {			
-				errno = 0;
-				v = (int)strtol(buf, &ptr, 10);
-				if (errno != 0) {
-					SETERR(err, 1);
-					goto errhandler;				
-				}
-				buf = ptr;
-
-				errno = 0;
-				w = strtol(buf, &ptr, 10);
-				if (errno != 0) {
-					SETERR(err, 1);
-					goto errhandler;				
-				}
-				buf = ptr;
-				
-				graph->adjv[j] = v - 1;
-				graph->edges[j] = w;
-				j++;
-				
-				while (*buf == ' ')
-					buf++;
-			} while (*buf != '\0');
-			
-			buf = line;
+			if (v < 1 || v > graph->nvertices) {
+				fprintf(stderr, "Invalid graph file %s\n", filename);
+				SETERR(err, 1);
+				goto errhandler;
+			}
+			graph->adjv[j] = v - 1;
+			graph->edges[j] = w;
+			j++;
 		}
-	}	
-	graph->adjindexes[graph->nvertices] = graph->nedges;
-	fprintf(stderr,"load graph step 9\n");
+	}
+	/* Header must count every adjacency entry of file */
+	if (j != graph->nedges) {
+		fprintf(stderr, "Invalid graph file %s\n", filename);
+		SETERR(err, 1);
+		goto errhandler;
+	}
+	graph->adjindexes[graph->nvertices] = j;
+	if (csrgraph_load_vchannels(graph, filename) != 0)
+		SETERR(err, 1);
+
 errhandler:
 	if (fin)
 		fclose(fin);
 	free(buf);
-	
+
 	if (err) {
-		if (graph) { 
+		if (graph) {
 			free(graph->adjindexes);
 			free(graph->adjv);
 			free(graph->edges);
+			for (i = 0; i < graph->nvchannels; i++)
+				free(graph->vchannels[i]);
 			free(graph);
 			graph = NULL;
 		}
@@ -194,11 +269,280 @@ errhandler:
 	return graph;
 }
 
-/* csrgraph_save: Save graph in CSR format. */
+/*
+ * csrgraph_load_vchannels: Read vertex weights of text graph from file
+ *                          <filename>.vw: header "nvertices nchannels" and
+ *                          line of weights of every vertex. Missing file
+ *                          is not error.
+ */
+static int csrgraph_load_vchannels(csrgraph_t *graph, const char *filename)
+{
+	FILE *fin;
+	char *vwname;
+	int n, nchannels, i, c, err = 0;
+
+	if ( (vwname = malloc(strlen(filename) + sizeof(".vw"))) == NULL)
+		return 1;
+	sprintf(vwname, "%s.vw", filename);
+	fin = fopen(vwname, "r");
+	free(vwname);
+	if (fin == NULL)
+		return 0;
+
+	if (fscanf(fin, "%d %d", &n, &nchannels) != 2 || n != graph->nvertices
+	    || nchannels < 0 || nchannels > CSRGRAPH_VCHANNELS_MAX)
+	{
+		err = 1;
+		goto errhandler;
+	}
+	for (c = 0; c < nchannels; c++) {
+		graph->vchannels[c] = malloc(sizeof(long long) * (n + 1));
+		if (graph->vchannels[c] == NULL) {
+			err = 1;
+			goto errhandler;
+		}
+		graph->nvchannels++;
+	}
+	for (i = 0; i < n; i++) {
+		for (c = 0; c < nchannels; c++) {
+			if (fscanf(fin, "%lld", &graph->vchannels[c][i]) != 1) {
+				err = 1;
+				goto errhandler;
+			}
+		}
+	}
+
+errhandler:
+	fclose(fin);
+	return err;
+}
+
+/*
+ * csrbin_isvalidarray: Returns 1 if array of given size at offset off is
+ *                      aligned and lies within the file.
+ */
+static int csrbin_isvalidarray(uint64_t off, uint64_t size, uint64_t filesize)
+{
+	return off % CSRBIN_ALIGN == 0 && off <= filesize
+	       && size <= filesize - off;
+}
+
+/* csrgraph_load_bin: Map binary graph file into memory. */
+csrgraph_t *csrgraph_load_bin(const char *filename)
+{
+	int fd, i, j, nvertices;
+	struct stat st;
+	void *addr = MAP_FAILED;
+	csrbin_header_t *h;
+	csrgraph_t *graph = NULL;
+
+	if ( (fd = open(filename, O_RDONLY)) < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(*h)) {
+		close(fd);
+		return NULL;
+	}
+
+	/* Private mapping: pages are shared with page cache until written */
+	addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	h = (csrbin_header_t *)addr;
+	nvertices = h->nvertices;
+	if (memcmp(h->magic, CSRBIN_MAGIC, CSRBIN_MAGIC_LEN) != 0
+	    || h->version != CSRBIN_VERSION
+	    || h->headersize != sizeof(*h)
+	    || h->filesize > (uint64_t)st.st_size
+	    || h->nechannels < 1 || h->nechannels > CSRBIN_ECHANNELS_MAX
+	    || h->nvchannels > CSRBIN_VCHANNELS_MAX
+	    || h->nvertices >= INT_MAX || h->nadj > INT_MAX
+	    || !csrbin_isvalidarray(h->off_adjindexes,
+	                            sizeof(int32_t) * ((uint64_t)nvertices + 1),
+	                            h->filesize)
+	    || !csrbin_isvalidarray(h->off_adjv, sizeof(int32_t) * h->nadj,
+	                            h->filesize)
+	    || !csrbin_isvalidarray(h->off_echannels[0], sizeof(int32_t) * h->nadj,
+	                            h->filesize))
+	{
+		goto invalid;
+	}
+
+	if ( (graph = malloc(sizeof(*graph))) == NULL)
+		goto errhandler;
+	graph->nvertices = nvertices;
+	graph->nedges = (int)h->nadj;
+	graph->adjindexes = (int *)((char *)addr + h->off_adjindexes);
+	graph->adjv = (int *)((char *)addr + h->off_adjv);
+	graph->edges = (int *)((char *)addr + h->off_echannels[0]);
+	graph->vparents = NULL;
+	graph->vweights = NULL;
+	graph->vmap = NULL;
+	graph->vfixed = NULL;
+	graph->nvchannels = 0;
+	memset(graph->vchannels, 0, sizeof(graph->vchannels));
+	graph->nnodes = 0;
+	graph->nodemap = NULL;
+	graph->mapaddr = addr;
+	graph->maplen = st.st_size;
+
+	if (graph->adjindexes[0] != 0
+	    || graph->adjindexes[nvertices] != graph->nedges)
+	{
+		goto invalid;
+	}
+	for (i = 0; i < nvertices; i++) {
+		if (graph->adjindexes[i] > graph->adjindexes[i + 1])
+			goto invalid;
+	}
+	for (j = 0; j < graph->nedges; j++) {
+		if (graph->adjv[j] < 0 || graph->adjv[j] >= nvertices)
+			goto invalid;
+	}
+
+	/* Vertex weights (profile) */
+	for (i = 0; i < (int)h->nvchannels; i++) {
+		if (h->off_vchannels[i] == 0
+		    || !csrbin_isvalidarray(h->off_vchannels[i],
+		                            sizeof(int64_t) * (uint64_t)nvertices,
+		                            h->filesize))
+		{
+			goto invalid;
+		}
+		graph->vchannels[i] = (long long *)((char *)addr
+		                                    + h->off_vchannels[i]);
+	}
+	graph->nvchannels = h->nvchannels;
+
+	/* Node layout of profiled job */
+	if (h->nnodes > 0) {
+		if (h->nnodes > INT_MAX
+		    || !csrbin_isvalidarray(h->off_nodemap,
+		                            sizeof(int32_t) * (uint64_t)nvertices,
+		                            h->filesize))
+		{
+			goto invalid;
+		}
+		graph->nodemap = (int *)((char *)addr + h->off_nodemap);
+		for (i = 0; i < nvertices; i++) {
+			if (graph->nodemap[i] < 0 || graph->nodemap[i] >= (int)h->nnodes)
+				goto invalid;
+		}
+		graph->nnodes = h->nnodes;
+	}
+	return graph;
+
+invalid:
+	fprintf(stderr, "Invalid binary graph file %s\n", filename);
+errhandler:
+	free(graph);
+	munmap(addr, st.st_size);
+	return NULL;
+}
+
+/* csrgraph_save_bin: Save graph in binary CSR format (see csrbin.h). */
+int csrgraph_save_bin(csrgraph_t *g, const char *filename)
+{
+	csrbin_header_t h;
+	FILE *fout;
+	int i, rc = 0;
+
+	if (g == NULL)
+		return 1;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CSRBIN_MAGIC, CSRBIN_MAGIC_LEN);
+	h.version = CSRBIN_VERSION;
+	h.headersize = sizeof(h);
+	h.nvertices = g->nvertices;
+	h.nadj = g->adjindexes[g->nvertices];
+	h.nechannels = 1;
+	h.off_adjindexes = CSRBIN_ALIGNUP(sizeof(h));
+	h.off_adjv = CSRBIN_ALIGNUP(h.off_adjindexes
+	                            + sizeof(int32_t) * (h.nvertices + 1));
+	h.off_echannels[0] = CSRBIN_ALIGNUP(h.off_adjv + sizeof(int32_t) * h.nadj);
+	h.filesize = h.off_echannels[0] + sizeof(int32_t) * h.nadj;
+	h.nvchannels = g->nvchannels;
+	for (i = 0; i < g->nvchannels; i++) {
+		h.off_vchannels[i] = CSRBIN_ALIGNUP(h.filesize);
+		h.filesize = h.off_vchannels[i] + sizeof(int64_t) * h.nvertices;
+	}
+	if (g->nodemap != NULL) {
+		h.nnodes = g->nnodes;
+		h.off_nodemap = CSRBIN_ALIGNUP(h.filesize);
+		h.filesize = h.off_nodemap + sizeof(int32_t) * h.nvertices;
+	}
+
+	if ( (fout = fopen(filename, "w")) == NULL)
+		return 1;
+	rc += csrgraph_write_at(fout, 0, &h, sizeof(h));
+	rc += csrgraph_write_at(fout, h.off_adjindexes, g->adjindexes,
+	                        sizeof(int32_t) * (h.nvertices + 1));
+	rc += csrgraph_write_at(fout, h.off_adjv, g->adjv,
+	                        sizeof(int32_t) * h.nadj);
+	rc += csrgraph_write_at(fout, h.off_echannels[0], g->edges,
+	                        sizeof(int32_t) * h.nadj);
+	for (i = 0; i < g->nvchannels; i++) {
+		rc += csrgraph_write_at(fout, h.off_vchannels[i], g->vchannels[i],
+		                        sizeof(int64_t) * h.nvertices);
+	}
+	if (g->nodemap != NULL) {
+		rc += csrgraph_write_at(fout, h.off_nodemap, g->nodemap,
+		                        sizeof(int32_t) * h.nvertices);
+	}
+	if (fclose(fout) != 0)
+		rc++;
+	return rc > 0 ? 1 : 0;
+}
+
+/* csrgraph_write_at: Write data at offset, padding gap with zeros. */
+int csrgraph_write_at(FILE *fout, uint64_t offset, const void *data,
+                      size_t size)
+{
+	long pos;
+
+	if ( (pos = ftell(fout)) < 0)
+		return 1;
+	for ( ; (uint64_t)pos < offset; pos++) {
+		if (fputc(0, fout) == EOF)
+			return 1;
+	}
+	if (size > 0 && fwrite(data, 1, size, fout) != size)
+		return 1;
+	return 0;
+}
+
+/* csrgraph_readline: Read line of arbitrary length; buffer grows. */
+char *csrgraph_readline(FILE *fin, char **buf, size_t *bufsize)
+{
+	size_t len = 0;
+	char *p;
+
+	for (;;) {
+		if (fgets(*buf + len, *bufsize - len, fin) == NULL)
+			return (len > 0) ? *buf : NULL;
+		len += strlen(*buf + len);
+		if (len > 0 && (*buf)[len - 1] == '\n')
+			return *buf;
+		if (len + 1 == *bufsize) {
+			if ( (p = realloc(*buf, *bufsize * 2)) == NULL)
+				return NULL;
+			*buf = p;
+			*bufsize *= 2;
+		}
+	}
+}
+
+/*
+ * csrgraph_save: Save graph in CSR format; vertex weights are saved to
+ *                <filename>.vw.
+ */
 int csrgraph_save(csrgraph_t *g, const char *filename)
 {
 	int i, j;
 	FILE *fout;
+	char *vwname;
 
 	if (g == NULL)
 		return 1;
@@ -212,7 +556,23 @@ int csrgraph_save(csrgraph_t *g, const char *filename)
 			fprintf(fout, "%d %d ", g->adjv[j] + 1, g->edges[j]);
 		fprintf(fout, "\n");
 	}
+	fclose(fout);
 
+	if (g->nvchannels == 0)
+		return 0;
+	if ( (vwname = malloc(strlen(filename) + sizeof(".vw"))) == NULL)
+		return 1;
+	sprintf(vwname, "%s.vw", filename);
+	fout = fopen(vwname, "w");
+	free(vwname);
+	if (fout == NULL)
+		return 1;
+	fprintf(fout, "%d %d\n", g->nvertices, g->nvchannels);
+	for (i = 0; i < g->nvertices; i++) {
+		for (j = 0; j < g->nvchannels; j++)
+			fprintf(fout, "%lld ", g->vchannels[j][i]);
+		fprintf(fout, "\n");
+	}
 	fclose(fout);
 	return 0;
 }
@@ -220,16 +580,27 @@ int csrgraph_save(csrgraph_t *g, const char *filename)
 /* csrgraph_free: Destroy graph. */
 void csrgraph_free(csrgraph_t *graph)
 {
+	int i;
+
 	if (graph) {
-		free(graph->adjindexes);
-		free(graph->adjv);
-		free(graph->edges);
-		if (graph->vparents);
+		if (graph->mapaddr) {
+			munmap(graph->mapaddr, graph->maplen);
+		} else {
+			free(graph->adjindexes);
+			free(graph->adjv);
+			free(graph->edges);
+			for (i = 0; i < graph->nvchannels; i++)
+				free(graph->vchannels[i]);
+			free(graph->nodemap);
+		}
+		if (graph->vparents)
 			free(graph->vparents);
 		if (graph->vweights)
 			free(graph->vweights);
 		if (graph->vmap)
 			free(graph->vmap);
+		if (graph->vfixed)
+			free(graph->vfixed);
 	}
 }
 
@@ -336,6 +707,68 @@ errhandler:
 	return 0;
 }
 
+/*
+ * csrgraph_subgraph: Return subgraph induced by vertices of partition p.
+ *                    Vertices of subgraph are mapped to vertices of source
+ *                    graph by vparents.
+ */
+csrgraph_t *csrgraph_subgraph(csrgraph_t *graph, const int *part, int p)
+{
+	int err = 0, i, j, nvertices = 0, nedges = 0, adjindex = 0;
+	int *old2new = NULL;
+	csrgraph_t *g = NULL;
+
+	if ( (old2new = malloc(sizeof(int) * graph->nvertices)) == NULL)
+		return NULL;
+
+	/* Compute number of vertices and edges in subgraph */
+	for (i = 0; i < graph->nvertices; i++) {
+		if (part[i] != p)
+			continue;
+		old2new[i] = nvertices++;
+		for (j = graph->adjindexes[i]; j < graph->adjindexes[i + 1]; j++) {
+			if (part[graph->adjv[j]] == p)
+				nedges++;
+		}
+	}
+
+	if ( (g = csrgraph_create(nvertices, nedges / 2)) == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+	g->nedges = nedges;
+	if ( (g->vparents = malloc(sizeof(int) * (nvertices + 1))) == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+
+	for (i = 0, nvertices = 0; i < graph->nvertices; i++) {
+		if (part[i] != p)
+			continue;
+		g->vparents[nvertices] = graph->vparents ? graph->vparents[i] : i;
+		g->adjindexes[nvertices++] = adjindex;
+		for (j = graph->adjindexes[i]; j < graph->adjindexes[i + 1]; j++) {
+			if (part[graph->adjv[j]] == p) {
+				g->adjv[adjindex] = old2new[graph->adjv[j]];
+				g->edges[adjindex] = graph->edges[j];
+				adjindex++;
+			}
+		}
+	}
+	g->adjindexes[nvertices] = adjindex;
+
+errhandler:
+	free(old2new);
+	if (err) {
+		if (g) {
+			csrgraph_free(g);
+			free(g);
+		}
+		return NULL;
+	}
+	return g;
+}
+
 /* csrgraph_print_adjmatrix: */
 void csrgraph_print_adjmatrix(csrgraph_t *graph)
 {
@@ -433,7 +866,7 @@ csrgraph_t *csrgraph_generate_bruck(int nvertices)
 		qsort(adj, nadjmax, sizeof(*adj), csrgraph_adjvertex_cmp);
 		for (k = 0, i = 0; i < nadjmax; ) {
 			g->adjv[g->adjindexes[r] + k] = adj[i].v;
-			for (m = 0, j = adj[i].v; adj[i].v == j && i < nadjmax; i++)
+			for (m = 0, j = adj[i].v; i < nadjmax && adj[i].v == j; i++)
 				m += adj[i].w;
 			g->edges[g->adjindexes[r] + k] = m;
 			k++;
@@ -443,41 +876,334 @@ csrgraph_t *csrgraph_generate_bruck(int nvertices)
 	return g;
 }
 
+/*
+ * csrgraph_recdoubling_adj: Partners of rank in recursive doubling.
+ *                           For n = pof2 + rem, even ranks below 2 * rem
+ *                           pass data to rank + 1 before and after
+ *                           exchanges of other pof2 ranks (as in MPICH).
+ */
+static int csrgraph_recdoubling_adj(int v, const void *arg,
+                                    struct csrgraph_adjvertex *adj)
+{
+	int n = *(const int *)arg;
+	int pof2, rem, newrank, mask, dst, deg = 0;
+
+	for (pof2 = 1; pof2 * 2 <= n; pof2 *= 2)
+		;
+	rem = n - pof2;
+
+	if (v < 2 * rem) {
+		adj[deg].v = (v % 2 == 0) ? v + 1 : v - 1;
+		adj[deg++].w = 2 * pof2;
+		if (v % 2 == 0)
+			return deg;
+		newrank = v / 2;
+	} else {
+		newrank = v - rem;
+	}
+	for (mask = 1; mask < pof2; mask *= 2) {
+		dst = newrank ^ mask;
+		adj[deg].v = (dst < rem) ? dst * 2 + 1 : dst + rem;
+		adj[deg++].w = 2 * mask;
+	}
+	return deg;
+}
+
 /*
  * csrgraph_generate_recdoubling: Generates task graph of recursive doubling
  *                                algorithm.
  */
 csrgraph_t *csrgraph_generate_recdoubling(int nvertices)
+{
+	if (nvertices < 2)
+		return NULL;
+	return csrgraph_generate(nvertices, 32, csrgraph_recdoubling_adj,
+	                         &nvertices);
+}
+
+/*
+ * csrgraph_generate: Generates graph from adjacency function.
+ *                    Function fills adjacency list of vertex (at most degmax
+ *                    entries); self-loops are dropped and duplicate
+ *                    neighbors are merged by sum of weights.
+ */
+static csrgraph_t *csrgraph_generate(int nvertices, int degmax,
+                                     csrgraph_adjfunc_t adjfunc,
+                                     const void *arg)
 {
 	csrgraph_t *g = NULL;
-	int i, k, r, nsteps, nedges;
-	int pof2;
+	struct csrgraph_adjvertex *adj;
+	int i, j, deg, nadj;
 
-	if (nvertices < 2)
+	if (nvertices < 1 || degmax < 0)
+		return NULL;
+	if ( (adj = malloc(sizeof(*adj) * (degmax + 1))) == NULL)
 		return NULL;
 
-	/* Compute degree of vertices and number of edges */
-	nsteps = ceil(log(nvertices) / log(2.0));
-	nedges = nsteps * nvertices / 2;
+	/* Compute number of edges */
+	for (i = 0, nadj = 0; i < nvertices; i++) {
+		deg = csrgraph_adjlist_normalize(i, adj, adjfunc(i, arg, adj));
+		if (nadj > INT_MAX - deg) {
+			free(adj);
+			return NULL;
+		}
+		nadj += deg;
+	}
 
 	/* Construct graph */
-	if ( (g = csrgraph_create(nvertices, nedges)) == NULL)
+	if ( (g = csrgraph_create(nvertices, (nadj + 1) / 2)) == NULL) {
+		free(adj);
 		return NULL;
-
-	/* Setup adjacency lists */
-	g->adjindexes[0] = 0;
-	for (i = 1; i < nvertices; i++)
-		g->adjindexes[i] = g->adjindexes[i - 1] + nsteps;
-	g->adjindexes[nvertices] = 2 * nedges;
+	}
+	g->nedges = nadj;
 
 	/* Fill adjacency lists */
-	for (r = 0; r < nvertices; r++) {
-		/* Fill list of process i */
-		k = g->adjindexes[r];
-		for (pof2 = 1, i = 0; pof2 < nvertices; pof2 *= 2, i++) {
-			g->adjv[k + i] = r ^ pof2;
-			g->edges[k + i] = 2 * pof2;
+	for (i = 0, nadj = 0; i < nvertices; i++) {
+		g->adjindexes[i] = nadj;
+		deg = csrgraph_adjlist_normalize(i, adj, adjfunc(i, arg, adj));
+		for (j = 0; j < deg; j++) {
+			g->adjv[nadj] = adj[j].v;
+			g->edges[nadj++] = adj[j].w;
 		}
 	}
+	g->adjindexes[nvertices] = nadj;
+	free(adj);
 	return g;
 }
+
+/* csrgraph_adjlist_normalize: Sort list, drop self-loops, merge duplicates. */
+static int csrgraph_adjlist_normalize(int v, struct csrgraph_adjvertex *adj,
+                                      int deg)
+{
+	int i, k;
+
+	qsort(adj, deg, sizeof(*adj), csrgraph_adjvertex_cmp);
+	for (i = 0, k = 0; i < deg; i++) {
+		if (adj[i].v == v)
+			continue;
+		if (k > 0 && adj[k - 1].v == adj[i].v)
+			adj[k - 1].w += adj[i].w;
+		else
+			adj[k++] = adj[i];
+	}
+	return k;
+}
+
+struct csrgraph_grid {
+	int ndims;
+	const int *dims;
+	const int *periodic;
+	const int *weights;
+};
+
+/*
+ * csrgraph_grid_adj: Neighbors of vertex in grid (row-major order, last
+ *                    dimension changes fastest as in MPI_Cart_create).
+ */
+static int csrgraph_grid_adj(int v, const void *arg,
+                             struct csrgraph_adjvertex *adj)
+{
+	const struct csrgraph_grid *grid = arg;
+	int d, c, stride, n, deg = 0;
+
+	for (d = grid->ndims - 1, stride = 1; d >= 0; d--) {
+		n = grid->dims[d];
+		c = (v / stride) % n;
+		if (c > 0) {
+			adj[deg].v = v - stride;
+			adj[deg++].w = grid->weights[d];
+		} else if (grid->periodic[d] && n > 2) {
+			adj[deg].v = v + (n - 1) * stride;
+			adj[deg++].w = grid->weights[d];
+		}
+		if (c < n - 1) {
+			adj[deg].v = v + stride;
+			adj[deg++].w = grid->weights[d];
+		} else if (grid->periodic[d] && n > 2) {
+			adj[deg].v = v - (n - 1) * stride;
+			adj[deg++].w = grid->weights[d];
+		}
+		stride *= n;
+	}
+	return deg;
+}
+
+/*
+ * csrgraph_generate_grid: Generates graph of Cartesian stencil.
+ *                         Edges along dimension d have weight weights[d];
+ *                         periodic dimensions have wraparound edges.
+ */
+csrgraph_t *csrgraph_generate_grid(int ndims, const int *dims,
+                                   const int *periodic, const int *weights)
+{
+	struct csrgraph_grid grid;
+	int d, nvertices;
+
+	if (ndims < 1)
+		return NULL;
+	for (d = 0, nvertices = 1; d < ndims; d++) {
+		if (dims[d] < 1 || nvertices > INT_MAX / dims[d])
+			return NULL;
+		nvertices *= dims[d];
+	}
+	grid.ndims = ndims;
+	grid.dims = dims;
+	grid.periodic = periodic;
+	grid.weights = weights;
+	return csrgraph_generate(nvertices, 2 * ndims, csrgraph_grid_adj, &grid);
+}
+
+/* csrgraph_generate_ring: Generates graph of ring. */
+csrgraph_t *csrgraph_generate_ring(int nvertices, int weight)
+{
+	int periodic = 1;
+
+	return csrgraph_generate_grid(1, &nvertices, &periodic, &weight);
+}
+
+/* csrgraph_tree_adj: Parent and children of vertex in binomial tree. */
+static int csrgraph_tree_adj(int v, const void *arg,
+                             struct csrgraph_adjvertex *adj)
+{
+	const int *params = arg;		/* nvertices, weight */
+	int pof2, deg = 0;
+
+	if (v > 0) {
+		adj[deg].v = v & (v - 1);
+		adj[deg++].w = params[1];
+	}
+	for (pof2 = 1; (v == 0 || pof2 < (v & -v))
+	               && pof2 < params[0] - v; pof2 *= 2)
+	{
+		adj[deg].v = v + pof2;
+		adj[deg++].w = params[1];
+	}
+	return deg;
+}
+
+/*
+ * csrgraph_generate_tree: Generates graph of binomial tree rooted at 0
+ *                         (broadcast and reduce algorithms).
+ */
+csrgraph_t *csrgraph_generate_tree(int nvertices, int weight)
+{
+	int params[2], nsteps;
+
+	params[0] = nvertices;
+	params[1] = weight;
+	for (nsteps = 0; nsteps < 31 && (1 << nsteps) < nvertices; nsteps++)
+		;
+	return csrgraph_generate(nvertices, nsteps + 1, csrgraph_tree_adj,
+	                         params);
+}
+
+struct csrgraph_butterfly {
+	int nvertices;
+	const int *weights;
+};
+
+/* csrgraph_butterfly_adj: Neighbors v xor 2^k of vertex in butterfly. */
+static int csrgraph_butterfly_adj(int v, const void *arg,
+                                  struct csrgraph_adjvertex *adj)
+{
+	const struct csrgraph_butterfly *bf = arg;
+	int k, deg = 0;
+
+	for (k = 0; k < 31 && (1 << k) < bf->nvertices; k++) {
+		if ((v ^ (1 << k)) < bf->nvertices) {
+			adj[deg].v = v ^ (1 << k);
+			adj[deg++].w = bf->weights[k];
+		}
+	}
+	return deg;
+}
+
+/*
+ * csrgraph_generate_butterfly: Generates butterfly (hypercube) graph.
+ *                              Edges of step k connect v and v xor 2^k and
+ *                              have weight weights[k], k < ceil(log2(n)).
+ */
+csrgraph_t *csrgraph_generate_butterfly(int nvertices, const int *weights)
+{
+	struct csrgraph_butterfly bf;
+
+	bf.nvertices = nvertices;
+	bf.weights = weights;
+	return csrgraph_generate(nvertices, 31, csrgraph_butterfly_adj, &bf);
+}
+
+/* csrgraph_complete_adj: All vertices except v. */
+static int csrgraph_complete_adj(int v, const void *arg,
+                                 struct csrgraph_adjvertex *adj)
+{
+	const int *params = arg;		/* nvertices, weight */
+	int i;
+
+	for (i = 0; i < params[0]; i++) {
+		adj[i].v = i;
+		adj[i].w = params[1];
+	}
+	return params[0];
+}
+
+/* csrgraph_generate_complete: Generates complete graph (all-to-all). */
+csrgraph_t *csrgraph_generate_complete(int nvertices, int weight)
+{
+	int params[2];
+
+	params[0] = nvertices;
+	params[1] = weight;
+	return csrgraph_generate(nvertices, nvertices, csrgraph_complete_adj,
+	                         params);
+}
+
+struct csrgraph_circulant {
+	int nvertices;
+	int noffsets;
+	const int *offsets;
+	const int *weights;
+};
+
+/* csrgraph_circulant_adj: Neighbors v + offset and v - offset (mod n). */
+static int csrgraph_circulant_adj(int v, const void *arg,
+                                  struct csrgraph_adjvertex *adj)
+{
+	const struct csrgraph_circulant *c = arg;
+	int k, s, deg = 0;
+
+	for (k = 0; k < c->noffsets; k++) {
+		s = c->offsets[k] % c->nvertices;
+		adj[deg].v = (v + s) % c->nvertices;
+		adj[deg++].w = c->weights[k];
+		if (2 * s != c->nvertices) {
+			adj[deg].v = (v + c->nvertices - s) % c->nvertices;
+			adj[deg++].w = c->weights[k];
+		}
+	}
+	return deg;
+}
+
+/*
+ * csrgraph_generate_circulant: Generates circulant graph: vertex v is linked
+ *                              with v + offsets[k] and v - offsets[k]
+ *                              (mod nvertices) by edge of weight weights[k].
+ */
+csrgraph_t *csrgraph_generate_circulant(int nvertices, int noffsets,
+                                        const int *offsets, const int *weights)
+{
+	struct csrgraph_circulant c;
+	int k;
+
+	if (noffsets < 0)
+		return NULL;
+	for (k = 0; k < noffsets; k++) {
+		if (offsets[k] < 0)
+			return NULL;
+	}
+	c.nvertices = nvertices;
+	c.noffsets = noffsets;
+	c.offsets = offsets;
+	c.weights = weights;
+	return csrgraph_generate(nvertices, 2 * noffsets, csrgraph_circulant_adj,
+	                         &c);
+}
@@ -0,0 +1,273 @@
+/*
+ * csrzip.c: Compressed CSR graph format (see csrzip.h).
+ *
+ * Decoder reads file through fixed size buffer and fills arrays of
+ * csrgraph_t directly, text representation of graph is never built.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "gpart.h"
+#include "csrzip.h"
+
+enum {
+	ZIPBUF_SIZE = 64 * 1024
+};
+
+typedef struct zipstream zipstream_t;
+struct zipstream {
+	FILE *f;
+	unsigned char buf[ZIPBUF_SIZE];
+	size_t pos;
+	size_t len;
+	int err;
+};
+
+struct zipadj {
+	int v, w;
+};
+
+static int zipstream_getc(zipstream_t *s);
+static uint64_t zipstream_get_varint(zipstream_t *s);
+static int zip_put_varint(FILE *fout, uint64_t x);
+static uint64_t zip_zigzag(int64_t x);
+static int64_t zip_unzigzag(uint64_t x);
+static uint64_t zip_quantize(int w);
+static int zip_dequantize(uint64_t q);
+static int zipadj_cmp(const void *a, const void *b);
+
+/* csrgraph_load_zip: Decode compressed graph file directly into CSR. */
+csrgraph_t *csrgraph_load_zip(const char *filename)
+{
+	zipstream_t *s = NULL;
+	csrgraph_t *graph = NULL;
+	char magic[CSRZIP_MAGIC_LEN];
+	uint64_t version, flags, nvertices, nadj, deg, q;
+	int64_t v;
+	int i, j, k;
+
+	if ( (s = malloc(sizeof(*s))) == NULL)
+		return NULL;
+	s->pos = s->len = 0;
+	s->err = 0;
+	if ( (s->f = fopen(filename, "r")) == NULL)
+		goto errhandler;
+
+	if (fread(magic, 1, CSRZIP_MAGIC_LEN, s->f) != CSRZIP_MAGIC_LEN
+	    || memcmp(magic, CSRZIP_MAGIC, CSRZIP_MAGIC_LEN) != 0)
+	{
+		goto errhandler;
+	}
+	version = zipstream_get_varint(s);
+	flags = zipstream_get_varint(s);
+	nvertices = zipstream_get_varint(s);
+	nadj = zipstream_get_varint(s);
+	if (s->err || version != CSRZIP_VERSION
+	    || nvertices > INT_MAX - 1 || nadj > INT_MAX - 1)
+	{
+		goto errhandler;
+	}
+
+	if ( (graph = csrgraph_create(nvertices, (nadj + 1) / 2)) == NULL)
+		goto errhandler;
+	graph->nedges = nadj;
+
+	for (i = 0, k = 0; i < (int)nvertices; i++) {
+		graph->adjindexes[i] = k;
+		deg = zipstream_get_varint(s);
+		if (s->err || deg > nadj - k)
+			goto errhandler;
+
+		/* Adjacency list */
+		for (j = 0; j < (int)deg; j++) {
+			if (j == 0)
+				v = i + zip_unzigzag(zipstream_get_varint(s));
+			else
+				v = graph->adjv[k + j - 1] + zipstream_get_varint(s);
+			if (v < 0 || v >= (int64_t)nvertices)
+				goto errhandler;
+			graph->adjv[k + j] = v;
+		}
+
+		/* Weights of edges */
+		for (j = 0; j < (int)deg; j++) {
+			q = zipstream_get_varint(s);
+			if (flags & CSRGRAPH_ZIP_LOGWEIGHTS)
+				graph->edges[k + j] = zip_dequantize(q);
+			else
+				graph->edges[k + j] = (q > INT_MAX) ? INT_MAX : (int)q;
+		}
+		if (s->err)
+			goto errhandler;
+		k += deg;
+	}
+	graph->adjindexes[nvertices] = k;
+	if (k != (int)nadj)
+		goto errhandler;
+
+	fclose(s->f);
+	free(s);
+	return graph;
+
+errhandler:
+	if (graph) {
+		csrgraph_free(graph);
+		free(graph);
+	}
+	if (s->f)
+		fclose(s->f);
+	free(s);
+	return NULL;
+}
+
+/*
+ * csrgraph_save_zip: Save graph in compressed CSR format (see csrzip.h).
+ *                    Flag CSRGRAPH_ZIP_LOGWEIGHTS enables lossy logarithmic
+ *                    quantization of weights.
+ */
+int csrgraph_save_zip(csrgraph_t *g, const char *filename, int flags)
+{
+	struct zipadj *row = NULL;
+	FILE *fout;
+	int i, j, deg, degmax = 0, rc = 0;
+
+	if (g == NULL)
+		return 1;
+
+	for (i = 0; i < g->nvertices; i++) {
+		deg = g->adjindexes[i + 1] - g->adjindexes[i];
+		if (deg > degmax)
+			degmax = deg;
+	}
+	if ( (row = malloc(sizeof(*row) * (degmax + 1))) == NULL)
+		return 1;
+
+	if ( (fout = fopen(filename, "w")) == NULL) {
+		free(row);
+		return 1;
+	}
+	if (fwrite(CSRZIP_MAGIC, 1, CSRZIP_MAGIC_LEN, fout) != CSRZIP_MAGIC_LEN)
+		rc++;
+	rc += zip_put_varint(fout, CSRZIP_VERSION);
+	rc += zip_put_varint(fout, flags & CSRGRAPH_ZIP_LOGWEIGHTS);
+	rc += zip_put_varint(fout, g->nvertices);
+	rc += zip_put_varint(fout, g->adjindexes[g->nvertices]);
+
+	for (i = 0; i < g->nvertices && rc == 0; i++) {
+		deg = g->adjindexes[i + 1] - g->adjindexes[i];
+		for (j = 0; j < deg; j++) {
+			row[j].v = g->adjv[g->adjindexes[i] + j];
+			row[j].w = g->edges[g->adjindexes[i] + j];
+		}
+		qsort(row, deg, sizeof(*row), zipadj_cmp);
+
+		rc += zip_put_varint(fout, deg);
+		for (j = 0; j < deg; j++) {
+			if (j == 0)
+				rc += zip_put_varint(fout, zip_zigzag((int64_t)row[j].v - i));
+			else
+				rc += zip_put_varint(fout, row[j].v - row[j - 1].v);
+		}
+		for (j = 0; j < deg; j++) {
+			if (flags & CSRGRAPH_ZIP_LOGWEIGHTS)
+				rc += zip_put_varint(fout, zip_quantize(row[j].w));
+			else
+				rc += zip_put_varint(fout, (row[j].w > 0) ? row[j].w : 0);
+		}
+	}
+
+	if (fclose(fout) != 0)
+		rc++;
+	free(row);
+	return rc > 0 ? 1 : 0;
+}
+
+/* zipstream_getc: Return next byte of stream or EOF. */
+static int zipstream_getc(zipstream_t *s)
+{
+	if (s->pos == s->len) {
+		s->len = fread(s->buf, 1, ZIPBUF_SIZE, s->f);
+		s->pos = 0;
+		if (s->len == 0) {
+			s->err = 1;
+			return EOF;
+		}
+	}
+	return s->buf[s->pos++];
+}
+
+/* zipstream_get_varint: Decode varint; sets error flag on truncated data. */
+static uint64_t zipstream_get_varint(zipstream_t *s)
+{
+	uint64_t x = 0;
+	int c, shift;
+
+	for (shift = 0; shift < 64; shift += 7) {
+		if ( (c = zipstream_getc(s)) == EOF)
+			return 0;
+		x |= (uint64_t)(c & 0x7f) << shift;
+		if ((c & 0x80) == 0)
+			return x;
+	}
+	s->err = 1;
+	return 0;
+}
+
+/* zip_put_varint: Encode varint; return 0 on success. */
+static int zip_put_varint(FILE *fout, uint64_t x)
+{
+	unsigned char buf[10];
+	int n = 0;
+
+	do {
+		buf[n] = x & 0x7f;
+		x >>= 7;
+		if (x)
+			buf[n] |= 0x80;
+		n++;
+	} while (x);
+	return fwrite(buf, 1, n, fout) != (size_t)n;
+}
+
+static uint64_t zip_zigzag(int64_t x)
+{
+	return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63);
+}
+
+static int64_t zip_unzigzag(uint64_t x)
+{
+	return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);
+}
+
+/* zip_quantize: Map weight to 1 + round(CSRZIP_LOGSCALE * log2(w)). */
+static uint64_t zip_quantize(int w)
+{
+	if (w <= 0)
+		return 0;
+	return 1 + (uint64_t)floor(CSRZIP_LOGSCALE * log2(w) + 0.5);
+}
+
+/* zip_dequantize: Restore weight; nonzero weights stay nonzero. */
+static int zip_dequantize(uint64_t q)
+{
+	double w;
+
+	if (q == 0)
+		return 0;
+	w = floor(exp2((q - 1) / CSRZIP_LOGSCALE) + 0.5);
+	if (w > INT_MAX)
+		return INT_MAX;
+	return (w < 1) ? 1 : (int)w;
+}
+
+static int zipadj_cmp(const void *a, const void *b)
+{
+	const struct zipadj *x = a, *y = b;
+
+	return (x->v > y->v) - (x->v < y->v);
+}
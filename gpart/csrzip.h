@@ -0,0 +1,40 @@
+/*
+ * csrzip.h: Compressed CSR graph format.
+ *
+ * Adjacency lists are sorted and delta-encoded, all numbers are stored as
+ * variable-length integers (7 bits per byte, high bit is continuation flag).
+ *
+ *   magic       8 bytes
+ *   version     varint
+ *   flags       varint (CSRZIP_LOGWEIGHTS)
+ *   nvertices   varint
+ *   nadj        varint (2 * number of edges)
+ *   for every vertex i:
+ *     degree    varint
+ *     adjv      zigzag(adjv[0] - i), then adjv[k] - adjv[k - 1]
+ *     edges     varint weight or, with CSRZIP_LOGWEIGHTS, quantized weight
+ *               q = 1 + round(CSRZIP_LOGSCALE * log2(w)) (q = 0 for w <= 0)
+ */
+
+#ifndef CSRZIP_H
+#define CSRZIP_H
+
+#include "gpart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CSRZIP_MAGIC      "GPARTCSZ"
+#define CSRZIP_MAGIC_LEN  8
+#define CSRZIP_VERSION    1
+#define CSRZIP_LOGSCALE   8.0		/* Quantization steps per octave */
+
+/* csrgraph_load_zip: Decode compressed graph file directly into CSR. */
+csrgraph_t *csrgraph_load_zip(const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSRZIP_H */
@@ -38,8 +38,20 @@
 #define MULTIVERTEX_WEIGHT_SCALE  1.45
 #define BISECTION_LND_ITERS_MAX   4
 
-static int gpart_partition_recursive_lnd(csrgraph_t *g, gpart_options_t *opt,
-		                                 int *pweights, int nparts, int *part,
+static int gpart_partition_capacities(csrgraph_t *g, gpart_hierarchy_t *h,
+		                              int regular, int *partweights,
+		                              int nparts, const int *fixed,
+		                              int *part);
+
+static int gpart_split_parts(int *partweights, int nparts);
+
+static int gpart_fill_parts(csrgraph_t *g, gpart_options_t *opt,
+		                    int *partweights, int nparts, int *part,
+		                    int startpartno);
+
+static int gpart_partition_recursive_lnd(csrgraph_t *g, gpart_hierarchy_t *h,
+		                                 gpart_options_t *opt, int *pweights,
+		                                 int nparts, int *part,
 		                                 int startpartno);
 
 static int gpart_partition_recursive_lnd_regular(csrgraph_t *g,
@@ -47,8 +59,9 @@ static int gpart_partition_recursive_lnd_regular(csrgraph_t *g,
 		                                         int *pweights, int nparts,
 		                                         int *part, int startpartno);
 
-static int gpart_bisect_multilevel(csrgraph_t *g, gpart_options_t *opt,
-		                           int *partsizes, int *bisection);
+static int gpart_bisect_multilevel(csrgraph_t *g, gpart_hierarchy_t *h,
+		                           gpart_options_t *opt, int *partsizes,
+		                           int *bisection);
 
 static int gpart_bisect_multilevel_regular(csrgraph_t *g, gpart_options_t *opt,
 		                                   int *partsizes, int *bisection);
@@ -68,7 +81,9 @@ static int gpart_bisect_lnd_regular(csrgraph_t *g, gpart_options_t *opt,
  *
  * Input:
  *     g is a weighted (edges) undirected graph.
- *     partweights is a array of required partition sizes (number of vertices).
+ *     partweights is a array of capacities of partitions (number of
+ *     vertices); capacity may be 0 and sum of capacities may exceed number
+ *     of vertices (see gpart_partition_capacities).
  *     nparts is a number of required partitions.
  *
  * Output:
@@ -83,28 +98,226 @@ static int gpart_bisect_lnd_regular(csrgraph_t *g, gpart_options_t *opt,
 int gpart_partition_recursive(csrgraph_t *g, int *partweights, int nparts,
 		                      int *part)
 {
-	int i, w;
+	return gpart_partition_capacities(g, NULL, 0, partweights, nparts, NULL,
+			                          part);
+}
+
+/*
+ * gpart_partition_fixed:
+ *
+ * Partition graph g as gpart_partition_recursive, vertex i is placed in
+ * part fixed[i] (or anywhere if fixed[i] is -1). Fixed vertices are kept
+ * by coarsening, initial bisection and FM refinement.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_partition_fixed(csrgraph_t *g, int *partweights, int nparts,
+		                  const int *fixed, int *part)
+{
+	return gpart_partition_capacities(g, NULL, 0, partweights, nparts, fixed,
+			                          part);
+}
+
+/*
+ * gpart_partition_recursive_hierarchy:
+ *
+ * Partition graph g as gpart_partition_recursive, but first bisection starts
+ * from saved hierarchy of coarse graphs of g (see gpart_hierarchy_build).
+ * Only initial partitioning and refinement are done for source graph;
+ * subgraphs are coarsened as usual.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_partition_recursive_hierarchy(csrgraph_t *g, gpart_hierarchy_t *h,
+		                                int *partweights, int nparts,
+		                                int *part)
+{
+	if (h == NULL || h->head->graph != g)
+		return 1;
+	return gpart_partition_capacities(g, h, 0, partweights, nparts, NULL,
+			                          part);
+}
+
+/*
+ * gpart_partition_capacities: Partition graph g into parts of capacities
+ *                             partweights. If capacities exceed number of
+ *                             vertices, parts of largest capacities are
+ *                             filled first (vertices are packed into
+ *                             fewer parts). Empty parts are excluded from
+ *                             recursive bisection. Vertices fixed in part
+ *                             are counted in its size first.
+ *                             Return 0 on success and 1 otherwise.
+ */
+static int gpart_partition_capacities(csrgraph_t *g, gpart_hierarchy_t *h,
+		                              int regular, int *partweights,
+		                              int nparts, const int *fixed,
+		                              int *part)
+{
 	gpart_options_t opt;
+	int *sizes = NULL, *index = NULL, *order = NULL, *pins = NULL;
+	int *vp = g->vparents;
+	int i, j, k, n, rest, rc = 1;
+	long long w;
 
-	if (nparts > g->nvertices)
-		return 0;
+	/* Fixed vertices of subgraph would be indexed by parent vertices */
+	if (nparts <= 0 || (fixed != NULL && vp != NULL))
+		return 1;
 	for (w = 0, i = 0; i < nparts; i++) {
-		if (partweights[i] == 0 || partweights[i] == g->nvertices)
-			return 0;
+		if (partweights[i] < 0)
+			return 1;
 		w += partweights[i];
 	}
-	if (w != g->nvertices)
-		return 0;
-
-	opt.coarse_graph_size = COARSE_GRAPH_SIZE_MAX;
-	opt.vweight_max = 1;
-	if (g->nvertices > opt.coarse_graph_size) {
-		opt.vweight_max = (int)(MULTIVERTEX_WEIGHT_SCALE
-		                        * (g->nvertices / opt.coarse_graph_size));
+	if (w < g->nvertices)
+		return 1;
+
+	sizes = calloc(nparts, sizeof(*sizes));
+	index = malloc(sizeof(*index) * nparts);
+	order = malloc(sizeof(*order) * nparts);
+	if (sizes == NULL || index == NULL || order == NULL)
+		goto errhandler;
+
+	/* Fixed vertices take their slots first */
+	rest = g->nvertices;
+	if (fixed != NULL) {
+		for (i = 0; i < g->nvertices; i++) {
+			if (fixed[i] == -1)
+				continue;
+			if (fixed[i] < 0 || fixed[i] >= nparts
+			    || ++sizes[fixed[i]] > partweights[fixed[i]])
+			{
+				goto errhandler;
+			}
+			rest--;
+		}
+	}
+
+	/* Sizes of parts: largest capacities first, stable on ties */
+	for (i = 0; i < nparts; i++) {
+		for (j = i; j > 0 && partweights[order[j - 1]] < partweights[i]; j--)
+			order[j] = order[j - 1];
+		order[j] = i;
+	}
+	for (i = 0; i < nparts; i++) {
+		k = order[i];
+		if ( (j = partweights[k] - sizes[k]) > rest)
+			j = rest;
+		sizes[k] += j;
+		rest -= j;
+	}
+
+	/* Nonempty parts keep their order, order[p] is new number of part p */
+	for (i = 0, n = 0; i < nparts; i++) {
+		order[i] = n;
+		if (sizes[i] > 0) {
+			index[n] = i;
+			sizes[n++] = sizes[i];
+		}
+	}
+	if (n <= 1) {
+		for (i = 0; i < g->nvertices; i++)
+			part[vp ? vp[i] : i] = index[0];
+		rc = 0;
+		goto errhandler;
+	}
+
+	gpart_default_options(g, &opt);
+	if (fixed != NULL) {
+		if ( (pins = malloc(sizeof(*pins) * g->nvertices)) == NULL)
+			goto errhandler;
+		for (i = 0; i < g->nvertices; i++)
+			pins[i] = fixed[i] >= 0 ? order[fixed[i]] : -1;
+		opt.fixed = pins;
+		h = NULL;
 	}
 
 	srand(0);
-	return gpart_partition_recursive_lnd(g, &opt, partweights, nparts, part, 0);
+	if (regular) {
+		rc = gpart_partition_recursive_lnd_regular(g, &opt, sizes, n, part,
+				                                   0);
+	} else {
+		rc = gpart_partition_recursive_lnd(g, h, &opt, sizes, n, part, 0);
+	}
+	for (i = 0; i < g->nvertices; i++)
+		part[vp ? vp[i] : i] = index[part[vp ? vp[i] : i]];
+
+errhandler:
+	free(sizes);
+	free(index);
+	free(order);
+	free(pins);
+	return rc;
+}
+
+/*
+ * gpart_split_parts: Return number of first parts of list which have half
+ *                    of weight of all parts (1 .. nparts - 1).
+ */
+static int gpart_split_parts(int *partweights, int nparts)
+{
+	long long total, prefix, diff, bestdiff;
+	int i, split;
+
+	for (i = 0, total = 0; i < nparts; i++)
+		total += partweights[i];
+	split = 1;
+	bestdiff = -1;
+	for (i = 1, prefix = 0; i < nparts; i++) {
+		prefix += partweights[i - 1];
+		diff = 2 * prefix - total;
+		if (diff < 0)
+			diff = -diff;
+		if (bestdiff < 0 || diff < bestdiff) {
+			bestdiff = diff;
+			split = i;
+		}
+	}
+	return split;
+}
+
+/*
+ * gpart_fill_parts: Partition graph without edges: fixed vertices are
+ *                   placed in their parts, other vertices fill parts in
+ *                   order. Return 0 on success and 1 otherwise.
+ */
+static int gpart_fill_parts(csrgraph_t *g, gpart_options_t *opt,
+		                    int *partweights, int nparts, int *part,
+		                    int startpartno)
+{
+	int *vp = g->vparents;
+	int i, k, p;
+	int *left;
+
+	if ( (left = malloc(sizeof(*left) * nparts)) == NULL)
+		return 1;
+	memcpy(left, partweights, sizeof(*left) * nparts);
+	for (i = 0; opt->fixed != NULL && i < g->nvertices; i++) {
+		if ( (p = opt->fixed[vp ? vp[i] : i]) >= 0) {
+			part[vp ? vp[i] : i] = p;
+			left[p - startpartno]--;
+		}
+	}
+	for (i = 0, k = 0; i < g->nvertices; i++) {
+		if (opt->fixed != NULL && opt->fixed[vp ? vp[i] : i] >= 0)
+			continue;
+		while (k < nparts - 1 && left[k] <= 0)
+			k++;
+		part[vp ? vp[i] : i] = k + startpartno;
+		left[k]--;
+	}
+	free(left);
+	return 0;
+}
+
+/* gpart_default_options: Setup coarsening options for graph g. */
+void gpart_default_options(csrgraph_t *g, gpart_options_t *opt)
+{
+	opt->coarse_graph_size = COARSE_GRAPH_SIZE_MAX;
+	opt->vweight_max = 1;
+	opt->fixed = NULL;
+	if (g->nvertices > opt->coarse_graph_size) {
+		opt->vweight_max = (int)(MULTIVERTEX_WEIGHT_SCALE
+		                         * (g->nvertices / opt->coarse_graph_size));
+	}
 }
 
 /*
@@ -131,58 +344,57 @@ int gpart_partition_recursive(csrgraph_t *g, int *partweights, int nparts,
 int gpart_partition_recursive_regular(csrgraph_t *g, int *partweights,
 		                              int nparts, int *part)
 {
-	int i, w;
-	gpart_options_t opt;
-
-	if (nparts > g->nvertices)
-		return 0;
-	for (w = 0, i = 0; i < nparts; i++) {
-		if (partweights[i] == 0 || partweights[i] == g->nvertices)
-			return 0;
-		w += partweights[i];
-	}
-	if (w != g->nvertices)
-		return 0;
-
-	opt.coarse_graph_size = COARSE_GRAPH_SIZE_MAX;
-	opt.vweight_max = 1;
-	if (g->nvertices > opt.coarse_graph_size) {
-		opt.vweight_max = (int)(MULTIVERTEX_WEIGHT_SCALE
-		                        * (g->nvertices / opt.coarse_graph_size));
-	}
-
-	srand(0);
-	return gpart_partition_recursive_lnd_regular(g, &opt, partweights, nparts,
-			                                     part, 0);
+	return gpart_partition_capacities(g, NULL, 1, partweights, nparts, NULL,
+			                          part);
 }
 
 /*
  * gpart_partition_recursive_lnd:
  *
  * Partition graph g into nparts subsets by recursive bisection.
+ * Hierarchy h of g (or NULL) is used for first bisection.
  * Return 0 on success and 1 otherwise.
  */
-int gpart_partition_recursive_lnd(csrgraph_t *g, gpart_options_t *opt,
-		                          int *partweights, int nparts, int *part,
-		                          int startpartno)
+int gpart_partition_recursive_lnd(csrgraph_t *g, gpart_hierarchy_t *h,
+		                          gpart_options_t *opt, int *partweights,
+		                          int nparts, int *part, int startpartno)
 {
 	int i, rc = 0;
 	int nvertices;
 	csrgraph_t *graphs[2] = {NULL, NULL};
 	int *bisection = NULL, *vparents;
-	int pw[2], pwresult[2], nmoves, moveto;
+	int pw[2], pwresult[2], nmoves, moveto, split, p;
+
+	/* Halves of bisection may have no edges */
+	if (g->nedges == 0)
+		return gpart_fill_parts(g, opt, partweights, nparts, part,
+		                        startpartno);
 
 	nvertices = g->nvertices;
 	if ( (bisection = malloc(sizeof(*bisection) * nvertices)) == NULL)
 		return 1;
 
-	/* Setup limits on partition sizes */
-	for (pw[0] = 0, i = 0; i < nparts / 2; i++)
-		pw[0] += partweights[i];		   /* Weight of 50% of vertices */
-	pw[1] = nvertices - pw[0];		   /* 100% - 50% of vertices */
+	/* Setup limits on partition sizes: halves of weight of parts */
+	split = gpart_split_parts(partweights, nparts);
+	for (pw[0] = 0, i = 0; i < split; i++)
+		pw[0] += partweights[i];
+	pw[1] = nvertices - pw[0];
+
+	/* Fixed vertices are fixed in half of their part */
+	vparents = g->vparents;
+	if (opt->fixed != NULL) {
+		if ( (g->vfixed = malloc(sizeof(*g->vfixed) * nvertices)) == NULL) {
+			free(bisection);
+			return 1;
+		}
+		for (i = 0; i < nvertices; i++) {
+			p = opt->fixed[vparents != NULL ? vparents[i] : i];
+			g->vfixed[i] = (p < 0) ? -1 : (p - startpartno >= split);
+		}
+	}
 
 	/* Bisect graph */
-	rc += gpart_bisect_multilevel(g, opt, pw, bisection);
+	rc += gpart_bisect_multilevel(g, h, opt, pw, bisection);
 
 	/* Balance size of partitions */
 	pwresult[0] = 0;
@@ -193,35 +405,37 @@ int gpart_partition_recursive_lnd(csrgraph_t *g, gpart_options_t *opt,
 	moveto = (pwresult[0] > pw[0]) ? 1 : 0;
 	if (nmoves > 0)
 		gpart_balance_bisection_fm(g, bisection, nmoves, moveto);
+	free(g->vfixed);
+	g->vfixed = NULL;
 
-	/* Save bisection */
-	if ((vparents = g->vparents) != NULL) {
+	/* Save bisection: second half starts from part split */
+	if (vparents != NULL) {
 		for (i = 0; i < nvertices; i++)
-			part[vparents[i]] = bisection[i] + startpartno;
+			part[vparents[i]] = bisection[i] * split + startpartno;
 	} else {
 		for (i = 0; i < nvertices; i++)
-			part[i] = bisection[i] + startpartno;
+			part[i] = bisection[i] * split + startpartno;
 	}
 
 	/* Divide graph on two subgraphs */
-	if (nparts > 2) {
-		csrgraph_bisect(g, bisection, &graphs[0], &graphs[1]);
+	if (nparts > 2
+	    && csrgraph_bisect(g, bisection, &graphs[0], &graphs[1]) != 0)
+	{
+		free(bisection);
+		return 1;
 	}
 	free(bisection);
 
 	/* Recursive partition subgraphs */
-	if (nparts > 3) {
-		rc += gpart_partition_recursive_lnd(graphs[0], opt, partweights,
-				                            nparts / 2, part, startpartno);
-		rc += gpart_partition_recursive_lnd(graphs[1], opt,
-				                            partweights + nparts / 2,
-				                            nparts - nparts / 2, part,
-				                            startpartno + nparts / 2);
-	} else if (nparts == 3) {
-		rc += gpart_partition_recursive_lnd(graphs[1], opt,
-				                            partweights + nparts / 2,
-				                            nparts - nparts / 2, part,
-				                            startpartno + nparts / 2);
+	if (split > 1) {
+		rc += gpart_partition_recursive_lnd(graphs[0], NULL, opt, partweights,
+				                            split, part, startpartno);
+	}
+	if (nparts - split > 1) {
+		rc += gpart_partition_recursive_lnd(graphs[1], NULL, opt,
+				                            partweights + split,
+				                            nparts - split, part,
+				                            startpartno + split);
 	}
 
 	csrgraph_free(graphs[0]);
@@ -244,16 +458,21 @@ int gpart_partition_recursive_lnd_regular(csrgraph_t *g, gpart_options_t *opt,
 	int nvertices;
 	csrgraph_t *graphs[2] = {NULL, NULL};
 	int *bisection = NULL, *vparents;
-	int pw[2], pwresult[2], nmoves, moveto;
+	int pw[2], pwresult[2], nmoves, moveto, split;
+
+	if (g->nedges == 0)
+		return gpart_fill_parts(g, opt, partweights, nparts, part,
+		                        startpartno);
 
 	nvertices = g->nvertices;
 	if ( (bisection = malloc(sizeof(*bisection) * nvertices)) == NULL)
 		return 1;
 
-	/* Setup limits on partition sizes */
-	for (pw[0] = 0, i = 0; i < nparts / 2; i++)
-		pw[0] += partweights[i];		   /* Weight of 50% of vertices */
-	pw[1] = nvertices - pw[0];		   /* 100% - 50% of vertices */
+	/* Setup limits on partition sizes: halves of weight of parts */
+	split = gpart_split_parts(partweights, nparts);
+	for (pw[0] = 0, i = 0; i < split; i++)
+		pw[0] += partweights[i];
+	pw[1] = nvertices - pw[0];
 
 	/* Bisect graph */
 	rc += gpart_bisect_multilevel_regular(g, opt, pw, bisection);
@@ -268,35 +487,34 @@ int gpart_partition_recursive_lnd_regular(csrgraph_t *g, gpart_options_t *opt,
 	if (nmoves > 0)
 		gpart_balance_bisection_fm(g, bisection, nmoves, moveto);
 
-	/* Save bisection */
+	/* Save bisection: second half starts from part split */
 	if ((vparents = g->vparents) != NULL) {
 		for (i = 0; i < nvertices; i++)
-			part[vparents[i]] = bisection[i] + startpartno;
+			part[vparents[i]] = bisection[i] * split + startpartno;
 	} else {
 		for (i = 0; i < nvertices; i++)
-			part[i] = bisection[i] + startpartno;
+			part[i] = bisection[i] * split + startpartno;
 	}
 
 	/* Divide graph on two subgraphs */
-	if (nparts > 2) {
-		csrgraph_bisect(g, bisection, &graphs[0], &graphs[1]);
+	if (nparts > 2
+	    && csrgraph_bisect(g, bisection, &graphs[0], &graphs[1]) != 0)
+	{
+		free(bisection);
+		return 1;
 	}
 	free(bisection);
 
 	/* Recursive partition subgraphs */
-	if (nparts > 3) {
+	if (split > 1) {
 		rc += gpart_partition_recursive_lnd_regular(graphs[0], opt, partweights,
-				                                    nparts / 2, part,
-				                                    startpartno);
-		rc += gpart_partition_recursive_lnd_regular(graphs[1], opt,
-				                                    partweights + nparts / 2,
-				                                    nparts - nparts / 2, part,
-				                                    startpartno + nparts / 2);
-	} else if (nparts == 3) {
+				                                    split, part, startpartno);
+	}
+	if (nparts - split > 1) {
 		rc += gpart_partition_recursive_lnd_regular(graphs[1], opt,
-				                                    partweights + nparts / 2,
-				                                    nparts - nparts / 2, part,
-				                                    startpartno + nparts / 2);
+				                                    partweights + split,
+				                                    nparts - split, part,
+				                                    startpartno + split);
 	}
 
 	csrgraph_free(graphs[0]);
@@ -307,17 +525,26 @@ int gpart_partition_recursive_lnd_regular(csrgraph_t *g, gpart_options_t *opt,
 
 /*
  * gpart_bisect_multilevel: Bisect graph using multilevel approach [*].
+ *                          Coarse graphs are taken from hierarchy h if it
+ *                          is not NULL.
  *                          Return 0 on success and 1 otherwise.
  *
  * [*] G. Karypis and V. Kumar. A fast and high quality multilevel scheme for
  *     partitioning irregular graphs // SIAM Journal on Scientific Computing,
  *     1999, Vol. 20, No. 1, P.359-392.
  */
-int gpart_bisect_multilevel(csrgraph_t *g, gpart_options_t *opt, int *partsizes,
+int gpart_bisect_multilevel(csrgraph_t *g, gpart_hierarchy_t *h,
+		                    gpart_options_t *opt, int *partsizes,
 		                    int *bisection)
 {
 	coarse_graph_t *cg = NULL;
 
+	if (h != NULL) {
+		gpart_bisect_lnd(h->coarsest->graph, opt, partsizes, bisection);
+		return gpart_project_bisection_hierarchy(h->coarsest, g, bisection,
+				                                 partsizes);
+	}
+
 	/* Build list of coarse graphs: |V0| < |V1| < ... < |Vm| */
 	cg = gpart_coarsen_graph(g, opt);
 
@@ -413,12 +640,33 @@ int gpart_bisect_lnd(csrgraph_t *g, gpart_options_t *opt, int *partsizes,
 			visited[i] = 0;
 		}
 
-		/* Start search from random vertex */
-		queue[0] = (int)(g->nvertices * (double)rand() /
-				         (double)(RAND_MAX + 1.0));
-		visited[queue[0]] = 1;
-		nleft = g->nvertices - 1;
-		qtop = 0; qtail = 1;
+		if (g->vfixed != NULL) {
+			/*
+			 * Search starts from vertices fixed in part 0, vertices fixed
+			 * in part 1 are not visited.
+			 */
+			nleft = g->nvertices;
+			qtop = 0; qtail = 0;
+			for (i = 0; i < g->nvertices; i++) {
+				if (g->vfixed[i] == -1)
+					continue;
+				if (g->vfixed[i] == 0) {
+					bisection[i] = 0;
+					pw[0] += g->vweights[i];
+					pw[1] -= g->vweights[i];
+					queue[qtail++] = i;
+				}
+				visited[i] = 1;
+				nleft--;
+			}
+		} else {
+			/* Start search from random vertex */
+			queue[0] = (int)(g->nvertices * (double)rand() /
+					         (double)(RAND_MAX + 1.0));
+			visited[queue[0]] = 1;
+			nleft = g->nvertices - 1;
+			qtop = 0; qtail = 1;
+		}
 
 		/* BFS */
 		for (;;) {
@@ -445,19 +693,21 @@ int gpart_bisect_lnd(csrgraph_t *g, gpart_options_t *opt, int *partsizes,
 				nleft--;
 			}
 
-			/* Visit vertex from queue */
+			/* Visit vertex from queue (fixed vertices are in part 0) */
 			i = queue[qtop++];
-			if (pw[0] > 0 && pw[1] - g->vweights[i] < pw_lim[1]) {
-				small = 1;
-				continue;
-			}
+			if (bisection[i] != 0) {
+				if (pw[0] > 0 && pw[1] - g->vweights[i] < pw_lim[1]) {
+					small = 1;
+					continue;
+				}
 
-			bisection[i] = 0;
-			pw[0] += g->vweights[i];
-			pw[1] -= g->vweights[i];
+				bisection[i] = 0;
+				pw[0] += g->vweights[i];
+				pw[1] -= g->vweights[i];
 
-			if (pw[1] <= pw_lim[1]) {
-				break;						/* Partition is done */
+				if (pw[1] <= pw_lim[1]) {
+					break;					/* Partition is done */
+				}
 			}
 
 			small = 0;
@@ -637,3 +887,25 @@ edgecut_t gpart_compute_edgecut(csrgraph_t *g, int *part)
 	edgecut /= 2;
 	return edgecut;
 }
+
+/* gpart_compute_maxexternal: Return maximal external volume of part. */
+edgecut_t gpart_compute_maxexternal(csrgraph_t *g, int *part, int nparts)
+{
+	edgecut_t *ext, maxext = 0;
+	int i, j;
+
+	if ( (ext = calloc(nparts, sizeof(*ext))) == NULL)
+		return EDGECUT_MAX;
+	for (i = 0; i < g->nvertices; i++) {
+		for (j = g->adjindexes[i]; j < g->adjindexes[i + 1]; j++) {
+			if (part[i] != part[g->adjv[j]])
+				ext[part[i]] += (edgecut_t)g->edges[j];
+		}
+	}
+	for (i = 0; i < nparts; i++) {
+		if (ext[i] > maxext)
+			maxext = ext[i];
+	}
+	free(ext);
+	return maxext;
+}
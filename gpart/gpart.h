@@ -26,6 +26,8 @@
 #ifndef GPART_H
 #define GPART_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,7 +41,12 @@ extern "C" {
  * Length of array adjv is 2 * nedges.
  * Example: adjv[adjindexes[3]] - is a number of first adj. vertex for node 3.
  *
+ * Profile graphs may have channels of vertex weights (compute time and
+ * memory of process, see csrbin.h); they are not kept by coarsening and
+ * subgraphs.
  */
+#define CSRGRAPH_VCHANNELS_MAX 4
+
 typedef struct csrgraph csrgraph_t;
 struct csrgraph {
 	int nvertices;		/* Number of vertices in graph */
@@ -51,6 +58,16 @@ struct csrgraph {
 	int *vparents;		/* Map bisection vertices to parent vertices */
 	int *vweights;		/* Weights of vertices (coarsening) */
 	int *vmap;			/* Map source vertices to coarse graph (coarsening) */
+	int *vfixed;		/* Fixed half of bisection or -1 (fixed vertices) */
+
+	int nvchannels;		/* Number of channels of vertex weights */
+	long long *vchannels[CSRGRAPH_VCHANNELS_MAX];
+
+	int nnodes;			/* Number of nodes of profiled job or 0 */
+	int *nodemap;		/* Node of vertex in profiled job or NULL */
+
+	void *mapaddr;		/* Mapped binary file (adjindexes, adjv, edges) */
+	size_t maplen;
 };
 
 #ifdef __USE_ISOC99
@@ -61,10 +78,14 @@ struct csrgraph {
 	typedef unsigned int edgecut_t;
 #endif
 
+/* Hierarchy of coarse graphs of source graph (see coarsen.h) */
+typedef struct gpart_hierarchy gpart_hierarchy_t;
+
 typedef struct gpart_options gpart_options_t;
 struct gpart_options {
 	int coarse_graph_size;
 	int vweight_max;		/* Limit on maximal weight of multivertex */
+	int *fixed;				/* Part of source vertex or -1, may be NULL */
 };
 
 /*
@@ -76,7 +97,10 @@ struct gpart_options {
  *
  * Input:
  *     g is a weighted (edges) undirected graph.
- *     partweights is a array of required partition sizes (number of vertices).
+ *     partweights is a array of capacities of partitions (number of
+ *     vertices). Capacities may differ and be 0; if their sum exceeds
+ *     number of vertices, partitions of largest capacities are filled
+ *     first. Parts are split between halves of bisection by weight.
  *     nparts is a number of required partitions.
  *
  * Output:
@@ -115,18 +139,131 @@ int gpart_partition_recursive(csrgraph_t *g, int *partweights,
 int gpart_partition_recursive_regular(csrgraph_t *g, int *partweights,
 		                              int nparts, int *part);
 
+/*
+ * gpart_partition_fixed:
+ *
+ * Partition graph g as gpart_partition_recursive with fixed vertices:
+ * vertex i is placed in part fixed[i] (or anywhere if fixed[i] is -1).
+ * Fixed vertices are matched only with free vertices or vertices of the
+ * same half of bisection while coarsening, part 0 of bisection grows from
+ * its fixed vertices and FM heuristic does not move fixed vertices, so
+ * other vertices are partitioned around them.
+ *
+ * Return 0 on success and 1 otherwise (number of vertices fixed in part
+ * exceeds its capacity or g is subgraph with vparents).
+ */
+int gpart_partition_fixed(csrgraph_t *g, int *partweights, int nparts,
+		                  const int *fixed, int *part);
+
+/*
+ * gpart_partition_recursive_hierarchy:
+ *
+ * Partition graph g as gpart_partition_recursive, but first bisection starts
+ * from hierarchy h of coarse graphs of g. Hierarchy depends only on graph and
+ * is reused for any partweights: only initial partitioning and refinement
+ * are done for source graph.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_partition_recursive_hierarchy(csrgraph_t *g, gpart_hierarchy_t *h,
+		                                int *partweights, int nparts,
+		                                int *part);
+
+/*
+ * gpart_hierarchy_build: Coarsen graph g. Hierarchy is bound to g (vertex
+ *                        weights and map of g are set) and must be freed
+ *                        before g.
+ */
+gpart_hierarchy_t *gpart_hierarchy_build(csrgraph_t *g);
+
+/*
+ * gpart_hierarchy_load: Read hierarchy of graph g from file.
+ *                       Return NULL if file is not hierarchy of g.
+ */
+gpart_hierarchy_t *gpart_hierarchy_load(csrgraph_t *g, const char *filename);
+
+/* gpart_hierarchy_save: Save hierarchy in file. Return 0 on success. */
+int gpart_hierarchy_save(gpart_hierarchy_t *h, const char *filename);
+
+/* gpart_hierarchy_free: Destroy coarse graphs of hierarchy. */
+void gpart_hierarchy_free(gpart_hierarchy_t *h);
+
 /* gpart_compute_edgecut: Return partition edge-cut. */
 edgecut_t gpart_compute_edgecut(csrgraph_t *g, int *part);
 
+/*
+ * gpart_compute_maxexternal: Return maximal external volume of part (sum of
+ *                            weights of cut edges incident to part).
+ */
+edgecut_t gpart_compute_maxexternal(csrgraph_t *g, int *part, int nparts);
+
+/*
+ * gpart_refine_minmax:
+ *
+ * k-way refinement of partition of g into nparts parts: objective is
+ * maximal external volume of part (traffic of busiest NIC). Vertex of
+ * busiest part is swapped with vertex of adjacent part if maximal external
+ * volume of two parts decreases (or does not change and their sum
+ * decreases); external volumes of parts are updated incrementally. Sizes
+ * of parts are kept. At most npasses * nvertices swaps (npasses 0 -
+ * default).
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_refine_minmax(csrgraph_t *g, int *part, int nparts, int npasses);
+
+/*
+ * gpart_balance_vchannels:
+ *
+ * Balance channels of vertex weights of g (compute time, memory) between
+ * parts of partition: sizes of parts are kept, share of part in channel is
+ * proportional to its size. While some part has load above (1 + tolerance)
+ * times its share, vertex of most overloaded part is swapped with vertex
+ * of other part: swap with minimal growth of edge-cut per unit of removed
+ * overload is taken. Vertices with fixed[v] >= 0 are not moved (fixed may
+ * be NULL). At most npasses * nvertices swaps (npasses 0 - default).
+ *
+ * Return 0 on success and 1 otherwise (load may stay above tolerance, see
+ * gpart_compute_imbalance).
+ */
+int gpart_balance_vchannels(csrgraph_t *g, int *part, int nparts,
+                            const int *fixed, double tolerance, int npasses);
+
+/*
+ * gpart_compute_imbalance: Return maximal ratio of load of part in channel
+ *                          of vertex weights to its share (1.0 is perfect
+ *                          balance) or -1.0 on error.
+ */
+double gpart_compute_imbalance(csrgraph_t *g, const int *part, int nparts,
+                               int channel);
+
 /* csrgraph_create: Allocate memory for graph. */
 csrgraph_t *csrgraph_create(int nvertices, int nedges);
 
-/* csrgraph_load: Read graph in CSR format from file. */
+/*
+ * csrgraph_load: Read graph in CSR format from file.
+ *                Format of file (text, binary or compressed) is detected
+ *                automatically.
+ */
 csrgraph_t *csrgraph_load(const char *filename);
 
 /* csrgraph_save: Save graph in file. */
 int csrgraph_save(csrgraph_t *g, const char *filename);
 
+/* csrgraph_save_bin: Save graph in binary CSR format (see csrbin.h). */
+int csrgraph_save_bin(csrgraph_t *g, const char *filename);
+
+/* Flags of csrgraph_save_zip */
+enum {
+	CSRGRAPH_ZIP_LOGWEIGHTS = 1		/* Lossy logarithmic quantization of weights */
+};
+
+/*
+ * csrgraph_save_zip: Save graph in compressed CSR format (see csrzip.h):
+ *                    delta-encoded sorted adjacency lists and varints.
+ */
+int csrgraph_save_zip(csrgraph_t *g, const char *filename, int flags);
+
 /* csrgraph_free: Destroy graph. */
 void csrgraph_free(csrgraph_t *graph);
 
@@ -137,6 +274,15 @@ int csrgraph_get_edge_weight(csrgraph_t *g, int i, int j);
 int csrgraph_bisect(csrgraph_t *graph, int *bisection,
 		            csrgraph_t **leftgraph, csrgraph_t **rightgraph);
 
+/*
+ * csrgraph_subgraph: Return subgraph induced by vertices of partition p.
+ *                    Vertices of subgraph are mapped to vertices of source
+ *                    graph by vparents, so partition of subgraph by
+ *                    gpart_partition_recursive is written to indexes of
+ *                    source graph.
+ */
+csrgraph_t *csrgraph_subgraph(csrgraph_t *graph, const int *part, int p);
+
 /* csrgraph_generate_bruck: Generates task graph of Bruck's algorithm. */
 csrgraph_t *csrgraph_generate_bruck(int nvertices);
 
@@ -146,6 +292,44 @@ csrgraph_t *csrgraph_generate_bruck(int nvertices);
  */
 csrgraph_t *csrgraph_generate_recdoubling(int nvertices);
 
+/*
+ * csrgraph_generate_grid: Generates graph of Cartesian stencil with ndims
+ *                         dimensions (vertices in row-major order as in
+ *                         MPI_Cart_create). Edges along dimension d have
+ *                         weight weights[d]; periodic dimensions are wrapped.
+ */
+csrgraph_t *csrgraph_generate_grid(int ndims, const int *dims,
+                                   const int *periodic, const int *weights);
+
+/* csrgraph_generate_ring: Generates graph of ring. */
+csrgraph_t *csrgraph_generate_ring(int nvertices, int weight);
+
+/*
+ * csrgraph_generate_tree: Generates graph of binomial tree rooted at 0
+ *                         (broadcast and reduce algorithms).
+ */
+csrgraph_t *csrgraph_generate_tree(int nvertices, int weight);
+
+/*
+ * csrgraph_generate_butterfly: Generates butterfly (hypercube) graph.
+ *                              Step k connects v and v xor 2^k with weight
+ *                              weights[k], k < ceil(log2(nvertices)).
+ */
+csrgraph_t *csrgraph_generate_butterfly(int nvertices, const int *weights);
+
+/* csrgraph_generate_complete: Generates complete graph (all-to-all). */
+csrgraph_t *csrgraph_generate_complete(int nvertices, int weight);
+
+/*
+ * csrgraph_generate_circulant: Generates circulant graph: vertex v is
+ *                              linked with v + offsets[k] and v - offsets[k]
+ *                              (mod nvertices) by edge of weight weights[k].
+ *                              Graph of Bruck's algorithm is circulant with
+ *                              offsets 2^k.
+ */
+csrgraph_t *csrgraph_generate_circulant(int nvertices, int noffsets,
+                                        const int *offsets, const int *weights);
+
 void csrgraph_print_adjmatrix(csrgraph_t *graph);
 
 #ifdef __cplusplus
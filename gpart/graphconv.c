@@ -0,0 +1,48 @@
+/*
+ * graphconv.c: Convert graph between text, binary and compressed CSR formats.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpart.h"
+
+int main(int argc, char **argv)
+{
+	csrgraph_t *graph;
+	int rc;
+
+	if (argc < 4 || strlen(argv[1]) != 2 || argv[1][0] != '-'
+	    || strchr("tbzq", argv[1][1]) == NULL)
+	{
+		fprintf(stderr, "Usage: graphconv -t|-b|-z|-q <input> <output>\n"
+		                "  -t  Save graph in text format\n"
+		                "  -b  Save graph in binary format\n"
+		                "  -z  Save graph in compressed format\n"
+		                "  -q  Save graph in compressed format with "
+		                "quantized weights\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if ( (graph = csrgraph_load(argv[2])) == NULL) {
+		fprintf(stderr, "Can not load graph file\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (strcmp(argv[1], "-b") == 0)
+		rc = csrgraph_save_bin(graph, argv[3]);
+	else if (strcmp(argv[1], "-z") == 0)
+		rc = csrgraph_save_zip(graph, argv[3], 0);
+	else if (strcmp(argv[1], "-q") == 0)
+		rc = csrgraph_save_zip(graph, argv[3], CSRGRAPH_ZIP_LOGWEIGHTS);
+	else
+		rc = csrgraph_save(graph, argv[3]);
+	csrgraph_free(graph);
+
+	if (rc > 0) {
+		fprintf(stderr, "Can not save graph file\n");
+		exit(EXIT_FAILURE);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,423 @@
+/*
+ * graphmerge.c: Merge profile graphs of several runs into one graph.
+ *
+ * Input graphs are read row by row: for every vertex the adjacency lists
+ * of all inputs are merged by k-way merge, so only one row per input is kept
+ * in memory. Inputs are text, binary or compressed graphs (binary files are
+ * mapped into memory, compressed files are decoded into memory). Result is
+ * written in CSR text format (see csrgraph_load).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <math.h>
+
+#include "gpart.h"
+#include "csrbin.h"
+#include "csrzip.h"
+
+enum {
+	MERGE_SUM = 0,
+	MERGE_AVG = 1,
+	MERGE_MAX = 2
+};
+
+enum {
+	LINESIZE_INIT = 4 * 1024,
+	HEADER_FIELD_WIDTH = 12
+};
+
+struct adjitem {
+	int v;
+	double w;
+};
+
+typedef struct graphstream graphstream_t;
+struct graphstream {
+	const char *filename;
+	FILE *fin;
+	csrgraph_t *graph;		/* Mapped binary graph or NULL */
+	int vertex;				/* Next row of binary graph */
+	int nvertices;
+	int nedges;
+	char *buf;
+	size_t bufsize;
+	struct adjitem *row;	/* Adjacency list of current vertex */
+	int rowlen;
+	int rowmax;
+	int pos;				/* Position of merge in row */
+	double total;			/* Total volume of graph */
+	double scale;			/* Scale of weights (normalization) */
+};
+
+static int graphstream_open(graphstream_t *s, const char *filename);
+static int graphstream_rewind(graphstream_t *s);
+static int graphstream_readrow(graphstream_t *s);
+static int graphstream_readrow_bin(graphstream_t *s);
+static void graphstream_close(graphstream_t *s);
+static int adjitem_cmp(const void *a, const void *b);
+static int adjitem_combine(struct adjitem *row, int rowlen);
+static void usage(void);
+
+int main(int argc, char **argv)
+{
+	graphstream_t *streams = NULL;
+	FILE *fout = NULL;
+	const char *output = NULL;
+	int op = MERGE_SUM, normalize = 0;
+	int nstreams, i, k, kmin, v, nentries, err = 0;
+	double w, wmax, totalavg;
+	long long wout;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "sum") == 0) {
+				op = MERGE_SUM;
+			} else if (strcmp(argv[i], "avg") == 0) {
+				op = MERGE_AVG;
+			} else if (strcmp(argv[i], "max") == 0) {
+				op = MERGE_MAX;
+			} else {
+				usage();
+			}
+		} else if (strcmp(argv[i], "-n") == 0) {
+			normalize = 1;
+		} else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else {
+			usage();
+		}
+	}
+	nstreams = argc - i;
+	if (output == NULL || nstreams < 1)
+		usage();
+
+	if ( (streams = calloc(nstreams, sizeof(*streams))) == NULL) {
+		fprintf(stderr, "No enough memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (k = 0; k < nstreams; k++) {
+		if (graphstream_open(&streams[k], argv[i + k]) > 0) {
+			fprintf(stderr, "Can not load graph file %s\n", argv[i + k]);
+			err = 1;
+			goto errhandler;
+		}
+		if (streams[k].nvertices != streams[0].nvertices) {
+			fprintf(stderr, "Graph %s has %d vertices, expected %d\n",
+			        argv[i + k], streams[k].nvertices, streams[0].nvertices);
+			err = 1;
+			goto errhandler;
+		}
+	}
+
+	/* First pass: total volume of every run */
+	if (normalize) {
+		for (totalavg = 0, k = 0; k < nstreams; k++) {
+			for (v = 0; v < streams[k].nvertices; v++) {
+				if (graphstream_readrow(&streams[k]) > 0) {
+					fprintf(stderr, "Can not read graph file %s\n",
+					        streams[k].filename);
+					err = 1;
+					goto errhandler;
+				}
+			}
+			totalavg += streams[k].total;
+			if (graphstream_rewind(&streams[k]) > 0) {
+				err = 1;
+				goto errhandler;
+			}
+		}
+		totalavg /= nstreams;
+		for (k = 0; k < nstreams; k++) {
+			if (streams[k].total > 0)
+				streams[k].scale = totalavg / streams[k].total;
+		}
+	}
+
+	if ( (fout = fopen(output, "w")) == NULL) {
+		fprintf(stderr, "Can not create file %s\n", output);
+		err = 1;
+		goto errhandler;
+	}
+
+	/* Number of edges is unknown until merge is done: reserve header */
+	fprintf(fout, "%*d %*d 1\n", HEADER_FIELD_WIDTH, streams[0].nvertices,
+	        HEADER_FIELD_WIDTH, 0);
+
+	for (nentries = 0, v = 0; v < streams[0].nvertices; v++) {
+		for (k = 0; k < nstreams; k++) {
+			if (graphstream_readrow(&streams[k]) > 0) {
+				fprintf(stderr, "Can not read graph file %s\n",
+				        streams[k].filename);
+				err = 1;
+				goto errhandler;
+			}
+		}
+
+		/* k-way merge of adjacency lists */
+		for (;;) {
+			for (kmin = -1, k = 0; k < nstreams; k++) {
+				if (streams[k].pos < streams[k].rowlen
+				    && (kmin == -1 || streams[k].row[streams[k].pos].v
+				                      < streams[kmin].row[streams[kmin].pos].v))
+				{
+					kmin = k;
+				}
+			}
+			if (kmin == -1)
+				break;
+
+			i = streams[kmin].row[streams[kmin].pos].v;
+			for (w = 0, wmax = 0, k = kmin; k < nstreams; k++) {
+				if (streams[k].pos < streams[k].rowlen
+				    && streams[k].row[streams[k].pos].v == i)
+				{
+					w += streams[k].row[streams[k].pos].w * streams[k].scale;
+					if (wmax < streams[k].row[streams[k].pos].w
+					           * streams[k].scale)
+					{
+						wmax = streams[k].row[streams[k].pos].w
+						       * streams[k].scale;
+					}
+					streams[k].pos++;
+				}
+			}
+			if (op == MERGE_AVG)
+				w /= nstreams;
+			else if (op == MERGE_MAX)
+				w = wmax;
+
+			/* Edge weights are int in csrgraph_t */
+			wout = llround(w);
+			if (wout < 1)
+				wout = 1;
+			if (wout > INT_MAX)
+				wout = INT_MAX;
+			fprintf(fout, "%d %lld ", i, wout);
+			nentries++;
+		}
+		fprintf(fout, "\n");
+	}
+
+	fseek(fout, 0, SEEK_SET);
+	fprintf(fout, "%*d %*d 1\n", HEADER_FIELD_WIDTH, streams[0].nvertices,
+	        HEADER_FIELD_WIDTH, nentries / 2);
+
+errhandler:
+	if (fout)
+		fclose(fout);
+	for (k = 0; k < nstreams; k++)
+		graphstream_close(&streams[k]);
+	free(streams);
+
+	return err ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* graphstream_open: Open graph file and read header. */
+int graphstream_open(graphstream_t *s, const char *filename)
+{
+	int fmt;
+	char magic[CSRBIN_MAGIC_LEN];
+
+	s->filename = filename;
+	s->scale = 1.0;
+	s->total = 0;
+	s->rowmax = 0;
+	s->rowlen = 0;
+	s->pos = 0;
+	s->row = NULL;
+	if ( (s->fin = fopen(filename, "r")) == NULL)
+		return 1;
+
+	if (fread(magic, 1, CSRBIN_MAGIC_LEN, s->fin) == CSRBIN_MAGIC_LEN
+	    && (memcmp(magic, CSRBIN_MAGIC, CSRBIN_MAGIC_LEN) == 0
+	        || memcmp(magic, CSRZIP_MAGIC, CSRZIP_MAGIC_LEN) == 0))
+	{
+		fclose(s->fin);
+		s->fin = NULL;
+		if ( (s->graph = csrgraph_load(filename)) == NULL)
+			return 1;
+		s->nvertices = s->graph->nvertices;
+		s->nedges = s->graph->nedges / 2;
+		s->vertex = 0;
+		return 0;
+	}
+	rewind(s->fin);
+
+	if (fscanf(s->fin, "%d %d %d", &s->nvertices, &s->nedges, &fmt) != 3)
+		return 1;
+	/* Skip rest of header line */
+	while ( (fmt = fgetc(s->fin)) != EOF && fmt != '\n')
+		;
+
+	s->bufsize = LINESIZE_INIT;
+	if ( (s->buf = malloc(s->bufsize)) == NULL)
+		return 1;
+	return 0;
+}
+
+/* graphstream_rewind: Go to first row of graph. */
+int graphstream_rewind(graphstream_t *s)
+{
+	int c;
+
+	if (s->graph) {
+		s->vertex = 0;
+		return 0;
+	}
+	if (fseek(s->fin, 0, SEEK_SET) != 0)
+		return 1;
+	while ( (c = fgetc(s->fin)) != EOF && c != '\n')
+		;
+	return 0;
+}
+
+/* graphstream_readrow: Read adjacency list of next vertex. */
+int graphstream_readrow(graphstream_t *s)
+{
+	size_t len = 0;
+	char *p, *ptr;
+	int sorted = 1;
+	struct adjitem *row;
+
+	s->rowlen = 0;
+	s->pos = 0;
+
+	if (s->graph)
+		return graphstream_readrow_bin(s);
+
+	/* Read line of arbitrary length */
+	for (;;) {
+		if (fgets(s->buf + len, s->bufsize - len, s->fin) == NULL) {
+			if (len == 0)
+				return 1;
+			break;
+		}
+		len += strlen(s->buf + len);
+		if (len > 0 && s->buf[len - 1] == '\n')
+			break;
+		if (len + 1 == s->bufsize) {
+			if ( (p = realloc(s->buf, s->bufsize * 2)) == NULL)
+				return 1;
+			s->buf = p;
+			s->bufsize *= 2;
+		}
+	}
+
+	for (p = s->buf; ; ) {
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '\n' || *p == '\r' || *p == '\0')
+			break;
+
+		if (s->rowlen == s->rowmax) {
+			s->rowmax = (s->rowmax > 0) ? s->rowmax * 2 : 64;
+			if ( (row = realloc(s->row, sizeof(*row) * s->rowmax)) == NULL)
+				return 1;
+			s->row = row;
+		}
+
+		errno = 0;
+		s->row[s->rowlen].v = (int)strtol(p, &ptr, 10);
+		if (errno != 0 || ptr == p)
+			return 1;
+		p = ptr;
+		errno = 0;
+		s->row[s->rowlen].w = (double)strtoull(p, &ptr, 10);
+		if (errno != 0 || ptr == p)
+			return 1;
+		p = ptr;
+
+		s->total += s->row[s->rowlen].w;
+		if (s->rowlen > 0 && s->row[s->rowlen - 1].v > s->row[s->rowlen].v)
+			sorted = 0;
+		s->rowlen++;
+	}
+
+	if (!sorted)
+		qsort(s->row, s->rowlen, sizeof(*s->row), adjitem_cmp);
+	s->rowlen = adjitem_combine(s->row, s->rowlen);
+	return 0;
+}
+
+/* graphstream_readrow_bin: Copy adjacency list of next vertex. */
+int graphstream_readrow_bin(graphstream_t *s)
+{
+	csrgraph_t *g = s->graph;
+	struct adjitem *row;
+	int j, sorted = 1;
+
+	if (s->vertex >= g->nvertices)
+		return 1;
+
+	s->rowlen = g->adjindexes[s->vertex + 1] - g->adjindexes[s->vertex];
+	if (s->rowlen > s->rowmax) {
+		if ( (row = realloc(s->row, sizeof(*row) * s->rowlen)) == NULL)
+			return 1;
+		s->row = row;
+		s->rowmax = s->rowlen;
+	}
+	for (j = 0; j < s->rowlen; j++) {
+		s->row[j].v = g->adjv[g->adjindexes[s->vertex] + j] + 1;
+		s->row[j].w = g->edges[g->adjindexes[s->vertex] + j];
+		s->total += s->row[j].w;
+		if (j > 0 && s->row[j - 1].v > s->row[j].v)
+			sorted = 0;
+	}
+	s->vertex++;
+
+	if (!sorted)
+		qsort(s->row, s->rowlen, sizeof(*s->row), adjitem_cmp);
+	s->rowlen = adjitem_combine(s->row, s->rowlen);
+	return 0;
+}
+
+/* graphstream_close: Close graph file and free memory. */
+void graphstream_close(graphstream_t *s)
+{
+	if (s->graph)
+		csrgraph_free(s->graph);
+	if (s->fin)
+		fclose(s->fin);
+	free(s->buf);
+	free(s->row);
+}
+
+/* adjitem_cmp: */
+int adjitem_cmp(const void *a, const void *b)
+{
+	if (((struct adjitem *)a)->v == ((struct adjitem *)b)->v)
+		return 0;
+	return (((struct adjitem *)a)->v < ((struct adjitem *)b)->v) ? -1 : 1;
+}
+
+/*
+ * adjitem_combine: Sum weights of repeated neighbours in sorted row.
+ *                  Returns new length of row.
+ */
+int adjitem_combine(struct adjitem *row, int rowlen)
+{
+	int i, n;
+
+	for (n = 0, i = 0; i < rowlen; i++) {
+		if (n > 0 && row[n - 1].v == row[i].v)
+			row[n - 1].w += row[i].w;
+		else
+			row[n++] = row[i];
+	}
+	return n;
+}
+
+void usage(void)
+{
+	fprintf(stderr, "Usage: graphmerge [-o sum|avg|max] [-n] -f <output> "
+	                "<graph1> [<graph2> ...]\n"
+	                "  -o  Merge operation on edge weights (default: sum)\n"
+	                "  -n  Normalize every run by its total volume\n");
+	exit(EXIT_FAILURE);
+}
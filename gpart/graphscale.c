@@ -0,0 +1,78 @@
+/*
+ * graphscale.c: Extrapolate profile graph to other number of vertices.
+ *
+ * Graph is fitted to parametric pattern (see pattern.h) and graph of
+ * pattern is synthesized for required number of vertices.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpart.h"
+#include "pattern.h"
+
+static void usage()
+{
+	fprintf(stderr, "Usage: graphscale [-s weak|strong] [-b] -n <nvertices> "
+	                "<input> <output>\n"
+	                "  -s  Scaling of weights (default weak)\n"
+	                "  -b  Save graph in binary format\n"
+	                "  -n  Number of vertices of output graph\n");
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+	csrgraph_t *graph, *scaled;
+	gpart_pattern_t pattern;
+	int i, scaling = GPART_SCALING_WEAK, binary = 0, nvertices = 0, rc;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			if ( (scaling = gpart_pattern_scaling(argv[++i])) < 0)
+				usage();
+		} else if (strcmp(argv[i], "-b") == 0) {
+			binary = 1;
+		} else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			nvertices = atoi(argv[++i]);
+		} else {
+			usage();
+		}
+	}
+	if (nvertices < 2 || argc - i != 2)
+		usage();
+
+	if ( (graph = csrgraph_load(argv[i])) == NULL) {
+		fprintf(stderr, "Can not load graph file\n");
+		exit(EXIT_FAILURE);
+	}
+
+	rc = gpart_pattern_fit(graph, &pattern);
+	gpart_pattern_print(&pattern, stderr);
+	csrgraph_free(graph);
+	free(graph);
+	if (rc > 0) {
+		fprintf(stderr, "Graph does not match any pattern\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if ( (scaled = gpart_pattern_generate(&pattern, nvertices, scaling))
+	     == NULL)
+	{
+		fprintf(stderr, "Can not generate graph\n");
+		exit(EXIT_FAILURE);
+	}
+	if (binary)
+		rc = csrgraph_save_bin(scaled, argv[i + 1]);
+	else
+		rc = csrgraph_save(scaled, argv[i + 1]);
+	csrgraph_free(scaled);
+	free(scaled);
+
+	if (rc > 0) {
+		fprintf(stderr, "Can not save graph file\n");
+		exit(EXIT_FAILURE);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,364 @@
+/*
+ * hierarchy.c: Saved hierarchy of coarse graphs.
+ *
+ * Coarse graphs of source graph depend only on graph, so hierarchy is
+ * built once and reused for partitions into any number of parts.
+ * File consists of header, map of source graph to first coarse graph and
+ * levels; byte order is native:
+ *
+ *   header      hierarchy_header_t
+ *   vmap        int32_t[nvertices]          (if nlevels > 0)
+ *   level k:    int32_t nvertices, nadj
+ *               adjindexes, adjv, edges, vweights
+ *               vmap                        (if k < nlevels)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "gpart.h"
+#include "coarsen.h"
+
+#define HIERARCHY_MAGIC      "GPARTHCY"
+#define HIERARCHY_MAGIC_LEN  8
+#define HIERARCHY_VERSION    1
+
+typedef struct hierarchy_header hierarchy_header_t;
+struct hierarchy_header {
+	char magic[HIERARCHY_MAGIC_LEN];
+	uint32_t version;
+	uint32_t nlevels;			/* Number of coarse graphs */
+	uint32_t nvertices;			/* Source graph */
+	uint32_t nadj;
+	uint64_t hash;				/* Hash of source graph */
+};
+
+static coarse_graph_t *hierarchy_read_level(FILE *fin, int hasvmap);
+static int hierarchy_check_vmap(const int *vmap, int n, int nnext);
+
+/* hierarchy_graph_hash: FNV-1a hash of CSR arrays of graph. */
+static uint64_t hierarchy_graph_hash(csrgraph_t *g)
+{
+	const unsigned char *p;
+	uint64_t h = 14695981039346656037ULL;
+	size_t i, n;
+	int k;
+
+	for (k = 0; k < 3; k++) {
+		if (k == 0) {
+			p = (const unsigned char *)g->adjindexes;
+			n = sizeof(int) * (g->nvertices + 1);
+		} else {
+			p = (const unsigned char *)(k == 1 ? g->adjv : g->edges);
+			n = sizeof(int) * g->nedges;
+		}
+		for (i = 0; i < n; i++)
+			h = (h ^ p[i]) * 1099511628211ULL;
+	}
+	return h;
+}
+
+/*
+ * gpart_hierarchy_build: Build hierarchy of coarse graphs of g.
+ *                        Hierarchy is bound to g (vertex weights and map
+ *                        of g are set).
+ */
+gpart_hierarchy_t *gpart_hierarchy_build(csrgraph_t *g)
+{
+	gpart_hierarchy_t *h;
+	gpart_options_t opt;
+	coarse_graph_t *cg;
+
+	if ( (h = malloc(sizeof(*h))) == NULL)
+		return NULL;
+
+	gpart_default_options(g, &opt);
+	free(g->vweights);
+	free(g->vmap);
+	g->vweights = NULL;
+	g->vmap = NULL;
+	srand(0);
+	if ( (cg = gpart_coarsen_graph(g, &opt)) == NULL) {
+		free(h);
+		return NULL;
+	}
+	h->coarsest = cg;
+	for (h->nlevels = 0; cg->prev != NULL; cg = cg->prev)
+		h->nlevels++;
+	h->head = cg;
+	h->hash = hierarchy_graph_hash(g);
+	return h;
+}
+
+/* gpart_hierarchy_free: Destroy coarse graphs of hierarchy. */
+void gpart_hierarchy_free(gpart_hierarchy_t *h)
+{
+	coarse_graph_t *cg, *p;
+
+	if (h == NULL)
+		return;
+	for (cg = h->coarsest; cg != NULL && cg != h->head; cg = p) {
+		p = cg->prev;
+		csrgraph_free(cg->graph);
+		free(cg->graph);
+		free(cg);
+	}
+	free(h->head);
+	free(h);
+}
+
+/* gpart_hierarchy_save: Save hierarchy in file. */
+int gpart_hierarchy_save(gpart_hierarchy_t *h, const char *filename)
+{
+	FILE *fout;
+	hierarchy_header_t hdr;
+	coarse_graph_t *cg;
+	csrgraph_t *g;
+	int32_t n[2];
+	int err = 0;
+
+	if ( (fout = fopen(filename, "wb")) == NULL)
+		return 1;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, HIERARCHY_MAGIC, HIERARCHY_MAGIC_LEN);
+	hdr.version = HIERARCHY_VERSION;
+	hdr.nlevels = (uint32_t)h->nlevels;
+	hdr.nvertices = (uint32_t)h->head->graph->nvertices;
+	hdr.nadj = (uint32_t)h->head->graph->nedges;
+	hdr.hash = h->hash;
+	if (fwrite(&hdr, sizeof(hdr), 1, fout) != 1)
+		err = 1;
+
+	g = h->head->graph;
+	if (!err && h->nlevels > 0
+	    && fwrite(g->vmap, sizeof(int), g->nvertices, fout)
+	       != (size_t)g->nvertices)
+	{
+		err = 1;
+	}
+
+	for (cg = h->head->next; !err && cg != NULL; cg = cg->next) {
+		g = cg->graph;
+		n[0] = g->nvertices;
+		n[1] = g->nedges;
+		if (fwrite(n, sizeof(n), 1, fout) != 1
+		    || fwrite(g->adjindexes, sizeof(int), g->nvertices + 1, fout)
+		       != (size_t)g->nvertices + 1
+		    || fwrite(g->adjv, sizeof(int), g->nedges, fout)
+		       != (size_t)g->nedges
+		    || fwrite(g->edges, sizeof(int), g->nedges, fout)
+		       != (size_t)g->nedges
+		    || fwrite(g->vweights, sizeof(int), g->nvertices, fout)
+		       != (size_t)g->nvertices)
+		{
+			err = 1;
+		}
+		if (!err && cg->next != NULL
+		    && fwrite(g->vmap, sizeof(int), g->nvertices, fout)
+		       != (size_t)g->nvertices)
+		{
+			err = 1;
+		}
+	}
+
+	if (fclose(fout) != 0)
+		err = 1;
+	return err;
+}
+
+/*
+ * gpart_hierarchy_load: Read hierarchy of graph g from file.
+ *                       Return NULL if file is not hierarchy of g.
+ */
+gpart_hierarchy_t *gpart_hierarchy_load(csrgraph_t *g, const char *filename)
+{
+	FILE *fin;
+	hierarchy_header_t hdr;
+	gpart_hierarchy_t *h = NULL;
+	coarse_graph_t *cg, *prev;
+	int *vmap = NULL, *vweights = NULL;
+	int i, err = 0;
+
+	if ( (fin = fopen(filename, "rb")) == NULL)
+		return NULL;
+
+	if (fread(&hdr, sizeof(hdr), 1, fin) != 1
+	    || memcmp(hdr.magic, HIERARCHY_MAGIC, HIERARCHY_MAGIC_LEN) != 0
+	    || hdr.version != HIERARCHY_VERSION
+	    || hdr.nvertices != (uint32_t)g->nvertices
+	    || hdr.nadj != (uint32_t)g->nedges
+	    || hdr.hash != hierarchy_graph_hash(g))
+	{
+		err = 1;
+		goto errhandler;
+	}
+
+	if ( (h = malloc(sizeof(*h))) == NULL
+	     || (h->head = malloc(sizeof(*h->head))) == NULL)
+	{
+		free(h);
+		h = NULL;
+		err = 1;
+		goto errhandler;
+	}
+	h->head->graph = g;
+	h->head->prev = NULL;
+	h->head->next = NULL;
+	h->coarsest = h->head;
+	h->nlevels = 0;
+	h->hash = hdr.hash;
+
+	if ( (vweights = malloc(sizeof(*vweights) * g->nvertices)) == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+	for (i = 0; i < g->nvertices; i++)
+		vweights[i] = 1;
+	if (hdr.nlevels > 0) {
+		if ( (vmap = malloc(sizeof(*vmap) * g->nvertices)) == NULL
+		     || fread(vmap, sizeof(int), g->nvertices, fin)
+		        != (size_t)g->nvertices)
+		{
+			err = 1;
+			goto errhandler;
+		}
+	}
+
+	for (prev = h->head; h->nlevels < (int)hdr.nlevels; prev = cg) {
+		/* Coarsest graph has no map */
+		if ( (cg = hierarchy_read_level(fin, h->nlevels + 1
+		                                     < (int)hdr.nlevels)) == NULL)
+		{
+			err = 1;
+			goto errhandler;
+		}
+		cg->prev = prev;
+		prev->next = cg;
+		h->coarsest = cg;
+		h->nlevels++;
+	}
+
+	/* Maps are indexes of next level while projection */
+	if (hdr.nlevels > 0
+	    && hierarchy_check_vmap(vmap, g->nvertices,
+	                            h->head->next->graph->nvertices) != 0)
+	{
+		err = 1;
+		goto errhandler;
+	}
+	for (cg = h->head->next; cg != NULL && cg->next != NULL; cg = cg->next) {
+		if (hierarchy_check_vmap(cg->graph->vmap, cg->graph->nvertices,
+		                         cg->next->graph->nvertices) != 0)
+		{
+			err = 1;
+			goto errhandler;
+		}
+	}
+
+errhandler:
+	fclose(fin);
+	if (err) {
+		gpart_hierarchy_free(h);
+		free(vmap);
+		free(vweights);
+		return NULL;
+	}
+
+	/* Hierarchy is bound to source graph */
+	free(g->vmap);
+	free(g->vweights);
+	g->vmap = vmap;
+	g->vweights = vweights;
+	return h;
+}
+
+/* hierarchy_read_level: Read coarse graph of hierarchy. */
+static coarse_graph_t *hierarchy_read_level(FILE *fin, int hasvmap)
+{
+	coarse_graph_t *cg = NULL;
+	csrgraph_t *g = NULL;
+	int32_t n[2];
+	int i, j, err = 0;
+
+	if (fread(n, sizeof(n), 1, fin) != 1 || n[0] <= 0 || n[1] < 0) {
+		err = 1;
+		goto errhandler;
+	}
+	if ( (cg = malloc(sizeof(*cg))) == NULL
+	     || (g = csrgraph_create(n[0], (n[1] + 1) / 2)) == NULL
+	     || (g->vweights = malloc(sizeof(int) * n[0])) == NULL)
+	{
+		err = 1;
+		goto errhandler;
+	}
+	g->nedges = n[1];
+	if (fread(g->adjindexes, sizeof(int), n[0] + 1, fin) != (size_t)n[0] + 1
+	    || fread(g->adjv, sizeof(int), n[1], fin) != (size_t)n[1]
+	    || fread(g->edges, sizeof(int), n[1], fin) != (size_t)n[1]
+	    || fread(g->vweights, sizeof(int), n[0], fin) != (size_t)n[0])
+	{
+		err = 1;
+		goto errhandler;
+	}
+
+	/* File of other build or truncated file is stale */
+	if (g->adjindexes[0] != 0 || g->adjindexes[n[0]] != n[1]) {
+		err = 1;
+		goto errhandler;
+	}
+	for (i = 0; i < n[0]; i++) {
+		if (g->adjindexes[i + 1] < g->adjindexes[i] || g->vweights[i] <= 0) {
+			err = 1;
+			goto errhandler;
+		}
+		for (j = g->adjindexes[i]; j < g->adjindexes[i + 1]; j++) {
+			if (g->adjv[j] < 0 || g->adjv[j] >= n[0]) {
+				err = 1;
+				goto errhandler;
+			}
+		}
+	}
+	if (hasvmap) {
+		if ( (g->vmap = malloc(sizeof(int) * n[0])) == NULL
+		     || fread(g->vmap, sizeof(int), n[0], fin) != (size_t)n[0])
+		{
+			err = 1;
+			goto errhandler;
+		}
+	}
+	cg->graph = g;
+	cg->prev = NULL;
+	cg->next = NULL;
+
+errhandler:
+	if (err) {
+		if (g) {
+			csrgraph_free(g);
+			free(g);
+		}
+		free(cg);
+		return NULL;
+	}
+	return cg;
+}
+
+/*
+ * hierarchy_check_vmap: Check that map of n vertices refers to vertices of
+ *                       next level (0 .. nnext - 1). Return 0 if map is
+ *                       valid.
+ */
+static int hierarchy_check_vmap(const int *vmap, int n, int nnext)
+{
+	int i;
+
+	if (vmap == NULL)
+		return 1;
+	for (i = 0; i < n; i++) {
+		if (vmap[i] < 0 || vmap[i] >= nnext)
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,487 @@
+/*
+ * mapeval.c: Offline evaluation of mappings of processes to nodes.
+ *
+ * Profile graph is mapped to every node layout (number of nodes times
+ * processes per node, or explicit layout of job) by every mapping, and
+ * communication metrics of mapping are reported: intra-node and inter-node
+ * volume, edge-cut (number of cut edges), hop-bytes, maximal external
+ * volume of node and communication time predicted by alpha-beta model.
+ * Pairs of layout and mapping are evaluated by threads. Binary profiles
+ * keep layout of profiled job, which is used if no layout is given.
+ *
+ * Model of time: edge is one message of its weight (bytes) in every
+ * direction. Inter-node messages of node are serialized by its NIC:
+ * node pays inter-node latency per cut edge and inter-node bandwidth per
+ * byte of external volume. Intra-node messages of processes are sent in
+ * parallel: node pays time of its busiest process by intra-node latency
+ * and bandwidth. Predicted time is time of slowest node.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gpart.h"
+#include "nettopo.h"
+
+#define MAPEVAL_LIST_MAX 64
+
+typedef struct mapeval_layout mapeval_layout_t;
+struct mapeval_layout {
+	int nnodes;
+	int ppn;					/* 0 for layout of job */
+	int *slots;					/* Processes of node */
+	const int *nodes;			/* Layout of job: node of process */
+};
+
+typedef struct mapeval_result mapeval_result_t;
+struct mapeval_result {
+	int err;
+	long long intra;			/* Volume inside nodes */
+	long long inter;			/* Volume between nodes */
+	long long cutedges;
+	long long hopbytes;			/* -1 if topology is too small */
+	long long maxext;
+	double time;				/* Seconds */
+};
+
+typedef struct mapeval mapeval_t;
+struct mapeval {
+	csrgraph_t *g;
+	mapeval_layout_t *layouts;
+	int nlayouts;
+	char *mappings[MAPEVAL_LIST_MAX];
+	int *mapfiles[MAPEVAL_LIST_MAX];	/* Parts of mapping file: */
+	int nmappings;
+	gpart_nettopo_t *topo;
+	double alpha, beta;			/* Inter-node latency (s), time of byte */
+	double alphaintra, betaintra;
+	mapeval_result_t *results;	/* results[layout * nmappings + mapping] */
+	int next;					/* Next pair to evaluate */
+	pthread_mutex_t lock;
+	pthread_mutex_t gpartlock;	/* Partitioning changes graph */
+};
+
+static void usage()
+{
+	fprintf(stderr, "Usage: mapeval [-n <nodes>[,...]] [-p <ppn>[,...]] "
+	                "[-l <layout>] [-m <mapping>[,...]]\n"
+	                "               [-t <topology>] [-a <us>] [-b <GB/s>] "
+	                "[-A <us>] [-B <GB/s>] [-j <threads>] <graph>\n"
+	                "  -n  Numbers of nodes (default: processes / ppn)\n"
+	                "  -p  Processes per node (default: processes / nodes)\n"
+	                "  -l  File with node of every process (layout of job,\n"
+	                "      default: layout of profiled job if graph has it)\n"
+	                "  -m  Mappings: identity, linear, rr, gpart, "
+	                "file:<path> (default identity,gpart)\n"
+	                "  -t  Network topology of nodes (see nettopo.h)\n"
+	                "  -a  Inter-node latency (default 2.0)\n"
+	                "  -b  Inter-node bandwidth (default 10.0)\n"
+	                "  -A  Intra-node latency (default 0.5)\n"
+	                "  -B  Intra-node bandwidth (default 40.0)\n"
+	                "  -j  Number of threads (default: number of CPUs)\n");
+	exit(EXIT_FAILURE);
+}
+
+/* mapeval_list: Parse list of positive integers, return its length. */
+static int mapeval_list(const char *s, int *list)
+{
+	char *end;
+	int n = 0;
+
+	for (;;) {
+		if (n == MAPEVAL_LIST_MAX)
+			return 0;
+		list[n] = (int)strtol(s, &end, 10);
+		if (end == s || list[n] <= 0)
+			return 0;
+		n++;
+		if (*end == '\0')
+			return n;
+		if (*end != ',')
+			return 0;
+		s = end + 1;
+	}
+}
+
+/*
+ * mapeval_load_parts: Read number of every process (node or part) from text
+ *                     file. Return NULL on error.
+ */
+static int *mapeval_load_parts(const char *filename, int nvertices)
+{
+	FILE *fin;
+	int *parts, i;
+
+	if ( (fin = fopen(filename, "r")) == NULL)
+		return NULL;
+	if ( (parts = malloc(sizeof(*parts) * nvertices)) == NULL) {
+		fclose(fin);
+		return NULL;
+	}
+	for (i = 0; i < nvertices; i++) {
+		if (fscanf(fin, "%d", &parts[i]) != 1 || parts[i] < 0) {
+			free(parts);
+			fclose(fin);
+			return NULL;
+		}
+	}
+	fclose(fin);
+	return parts;
+}
+
+/* mapeval_map: Map processes to nodes of layout. Return 0 on success. */
+static int mapeval_map(mapeval_t *e, mapeval_layout_t *l, int m, int *part)
+{
+	csrgraph_t *g = e->g;
+	int *left, i, p, rc;
+
+	if (strcmp(e->mappings[m], "identity") == 0) {
+		/* Placement of launch: layout of job or block by ppn */
+		for (i = 0; i < g->nvertices; i++)
+			part[i] = l->nodes ? l->nodes[i] : i / l->ppn;
+		return 0;
+	} else if (e->mapfiles[m] != NULL) {
+		for (i = 0; i < g->nvertices; i++) {
+			if ( (part[i] = e->mapfiles[m][i]) >= l->nnodes)
+				return 1;
+		}
+		return 0;
+	} else if (strcmp(e->mappings[m], "gpart") == 0) {
+		pthread_mutex_lock(&e->gpartlock);
+		rc = gpart_partition_recursive(g, l->slots, l->nnodes, part);
+		pthread_mutex_unlock(&e->gpartlock);
+		return rc;
+	}
+
+	if ( (left = malloc(sizeof(*left) * l->nnodes)) == NULL)
+		return 1;
+	memcpy(left, l->slots, sizeof(*left) * l->nnodes);
+	for (i = 0, p = 0; i < g->nvertices; i++) {
+		if (strcmp(e->mappings[m], "rr") == 0) {
+			/* Next node with free slot */
+			while (left[p % l->nnodes] == 0)
+				p++;
+			part[i] = p++ % l->nnodes;
+		} else {
+			/* Nodes are filled in order */
+			while (left[p] == 0)
+				p++;
+			part[i] = p;
+		}
+		left[part[i]]--;
+	}
+	free(left);
+	return 0;
+}
+
+/* mapeval_metrics: Compute metrics of mapping part. */
+static int mapeval_metrics(mapeval_t *e, mapeval_layout_t *l, const int *part,
+                           mapeval_result_t *r)
+{
+	csrgraph_t *g = e->g;
+	long long *ext, *extedges;
+	double *intratime, t;
+	int i, j, u, p, dist = 1, hops;
+
+	ext = calloc(l->nnodes, sizeof(*ext));
+	extedges = calloc(l->nnodes, sizeof(*extedges));
+	intratime = calloc(l->nnodes, sizeof(*intratime));
+	if (ext == NULL || extedges == NULL || intratime == NULL) {
+		free(ext);
+		free(extedges);
+		free(intratime);
+		return 1;
+	}
+	hops = e->topo != NULL && e->topo->nnodes >= l->nnodes;
+
+	for (i = 0; i < g->nvertices; i++) {
+		p = part[i];
+		for (j = g->adjindexes[i], t = 0; j < g->adjindexes[i + 1]; j++) {
+			u = g->adjv[j];
+			if (part[u] == p) {
+				t += e->alphaintra + g->edges[j] * e->betaintra;
+				if (u > i)
+					r->intra += g->edges[j];
+				continue;
+			}
+			ext[p] += g->edges[j];
+			extedges[p]++;
+			if (u > i) {
+				if (hops)
+					dist = gpart_nettopo_distance(e->topo, p, part[u]);
+				r->inter += g->edges[j];
+				r->hopbytes += (long long)g->edges[j] * dist;
+				r->cutedges++;
+			}
+		}
+		if (t > intratime[p])
+			intratime[p] = t;
+	}
+	for (p = 0; p < l->nnodes; p++) {
+		t = extedges[p] * e->alpha + ext[p] * e->beta + intratime[p];
+		if (t > r->time)
+			r->time = t;
+		if (ext[p] > r->maxext)
+			r->maxext = ext[p];
+	}
+	if (e->topo != NULL && !hops)
+		r->hopbytes = -1;
+
+	free(ext);
+	free(extedges);
+	free(intratime);
+	return 0;
+}
+
+/* mapeval_thread: Evaluate pairs of layout and mapping until none is left. */
+static void *mapeval_thread(void *arg)
+{
+	mapeval_t *e = arg;
+	mapeval_result_t *r;
+	int *part, k;
+
+	part = malloc(sizeof(*part) * e->g->nvertices);
+	for (;;) {
+		pthread_mutex_lock(&e->lock);
+		k = e->next++;
+		pthread_mutex_unlock(&e->lock);
+		if (k >= e->nlayouts * e->nmappings)
+			break;
+		r = &e->results[k];
+		r->err = part == NULL
+		         || mapeval_map(e, &e->layouts[k / e->nmappings],
+		                        k % e->nmappings, part)
+		         || mapeval_metrics(e, &e->layouts[k / e->nmappings], part,
+		                            r);
+	}
+	free(part);
+	return NULL;
+}
+
+/* mapeval_print: Print results in order of layouts and mappings. */
+static void mapeval_print(mapeval_t *e)
+{
+	mapeval_layout_t *l;
+	mapeval_result_t *r;
+	char ppn[16], hopbytes[24];
+	int k;
+
+	printf("%6s %5s %-16s %14s %14s %10s %16s %14s %12s\n", "nodes", "ppn",
+	       "mapping", "intra", "inter", "cutedges", "hopbytes", "maxext",
+	       "time_ms");
+	for (k = 0; k < e->nlayouts * e->nmappings; k++) {
+		l = &e->layouts[k / e->nmappings];
+		r = &e->results[k];
+		snprintf(ppn, sizeof(ppn), l->ppn > 0 ? "%d" : "-", l->ppn);
+		if (r->err) {
+			printf("%6d %5s %-16s error\n", l->nnodes, ppn,
+			       e->mappings[k % e->nmappings]);
+			continue;
+		}
+		snprintf(hopbytes, sizeof(hopbytes), r->hopbytes >= 0 ? "%lld" : "-",
+		         r->hopbytes);
+		printf("%6d %5s %-16s %14lld %14lld %10lld %16s %14lld %12.3f\n",
+		       l->nnodes, ppn, e->mappings[k % e->nmappings], r->intra,
+		       r->inter, r->cutedges, hopbytes, r->maxext, r->time * 1e3);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	mapeval_t e;
+	pthread_t *threads;
+	char *layoutfile = NULL, *topo = NULL, *s, *end;
+	int nodes[MAPEVAL_LIST_MAX], ppns[MAPEVAL_LIST_MAX], *jobnodes = NULL;
+	int nnodes = 0, nppns = 0, nthreads = 0, pairs = 0, i, j, k, n;
+
+	memset(&e, 0, sizeof(e));
+	e.alpha = 2.0e-6;
+	e.beta = 1.0 / 10.0e9;
+	e.alphaintra = 0.5e-6;
+	e.betaintra = 1.0 / 40.0e9;
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (i + 1 == argc || argv[i][1] == '\0' || argv[i][2] != '\0')
+			usage();
+		s = argv[++i];
+		switch (argv[i - 1][1]) {
+		case 'n':
+			if ( (nnodes = mapeval_list(s, nodes)) == 0)
+				usage();
+			break;
+		case 'p':
+			if ( (nppns = mapeval_list(s, ppns)) == 0)
+				usage();
+			break;
+		case 'l':
+			layoutfile = s;
+			break;
+		case 't':
+			topo = s;
+			break;
+		case 'm':
+			/* Names are split in place */
+			for (; s != NULL; s = end) {
+				if (e.nmappings == MAPEVAL_LIST_MAX)
+					usage();
+				if ( (end = strchr(s, ',')) != NULL)
+					*end++ = '\0';
+				e.mappings[e.nmappings++] = s;
+			}
+			break;
+		case 'a':
+			e.alpha = atof(s) * 1e-6;
+			break;
+		case 'b':
+			if (atof(s) <= 0)
+				usage();
+			e.beta = 1.0 / (atof(s) * 1e9);
+			break;
+		case 'A':
+			e.alphaintra = atof(s) * 1e-6;
+			break;
+		case 'B':
+			if (atof(s) <= 0)
+				usage();
+			e.betaintra = 1.0 / (atof(s) * 1e9);
+			break;
+		case 'j':
+			if ( (nthreads = atoi(s)) <= 0)
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+	if (argc - i != 1)
+		usage();
+	if (e.nmappings == 0) {
+		e.mappings[e.nmappings++] = "identity";
+		e.mappings[e.nmappings++] = "gpart";
+	}
+
+	if ( (e.g = csrgraph_load(argv[i])) == NULL) {
+		fprintf(stderr, "Can not load graph file\n");
+		exit(EXIT_FAILURE);
+	}
+	n = e.g->nvertices;
+	if (layoutfile == NULL && nnodes == 0 && nppns == 0 && e.g->nodemap == NULL)
+		usage();
+	for (k = 0; k < e.nmappings; k++) {
+		if (strncmp(e.mappings[k], "file:", 5) == 0) {
+			if ( (e.mapfiles[k] = mapeval_load_parts(e.mappings[k] + 5, n))
+			     == NULL)
+			{
+				fprintf(stderr, "Can not load mapping %s\n",
+				        e.mappings[k] + 5);
+				exit(EXIT_FAILURE);
+			}
+		} else if (strcmp(e.mappings[k], "identity") != 0
+		           && strcmp(e.mappings[k], "linear") != 0
+		           && strcmp(e.mappings[k], "rr") != 0
+		           && strcmp(e.mappings[k], "gpart") != 0)
+		{
+			fprintf(stderr, "Unknown mapping %s\n", e.mappings[k]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (topo != NULL && (e.topo = gpart_nettopo_parse(topo)) == NULL) {
+		fprintf(stderr, "Can not parse topology %s\n", topo);
+		exit(EXIT_FAILURE);
+	}
+
+	/* Layout of job or sweep over numbers of nodes and ppn */
+	if (layoutfile != NULL || (nnodes == 0 && nppns == 0)) {
+		if (layoutfile == NULL) {
+			jobnodes = e.g->nodemap;
+		} else if ( (jobnodes = mapeval_load_parts(layoutfile, n)) == NULL) {
+			fprintf(stderr, "Can not load layout %s\n", layoutfile);
+			exit(EXIT_FAILURE);
+		}
+		nnodes = 1;
+		nodes[0] = 0;
+		for (j = 0; j < n; j++) {
+			if (jobnodes[j] >= nodes[0])
+				nodes[0] = jobnodes[j] + 1;
+		}
+		nppns = 1;
+		ppns[0] = 0;
+	} else if (nnodes == 0) {
+		for (nnodes = 0; nnodes < nppns; nnodes++)
+			nodes[nnodes] = (n + ppns[nnodes] - 1) / ppns[nnodes];
+		pairs = 1;
+	} else if (nppns == 0) {
+		for (nppns = 0; nppns < nnodes; nppns++)
+			ppns[nppns] = (n + nodes[nppns] - 1) / nodes[nppns];
+		pairs = 1;
+	}
+	/* Sweep is product of lists, derived list is paired with given one */
+	e.layouts = calloc(nnodes * nppns, sizeof(*e.layouts));
+	if (e.layouts == NULL)
+		exit(EXIT_FAILURE);
+	for (j = 0; j < nnodes * nppns; j++) {
+		if (pairs && j / nppns != j % nppns)
+			continue;
+		e.layouts[e.nlayouts].nnodes = nodes[j / nppns];
+		e.layouts[e.nlayouts].ppn = ppns[j % nppns];
+		e.layouts[e.nlayouts].nodes = jobnodes;
+		if ( (long long)nodes[j / nppns] * ppns[j % nppns] < n
+		    && jobnodes == NULL)
+		{
+			fprintf(stderr, "Layout %d x %d is too small for %d processes\n",
+			        nodes[j / nppns], ppns[j % nppns], n);
+			continue;
+		}
+		e.nlayouts++;
+	}
+	for (j = 0; j < e.nlayouts; j++) {
+		e.layouts[j].slots = calloc(e.layouts[j].nnodes, sizeof(int));
+		if (e.layouts[j].slots == NULL)
+			exit(EXIT_FAILURE);
+		for (k = 0; k < e.layouts[j].nnodes; k++) {
+			if (jobnodes == NULL)
+				e.layouts[j].slots[k] = e.layouts[j].ppn;
+		}
+		for (k = 0; jobnodes != NULL && k < n; k++)
+			e.layouts[j].slots[jobnodes[k]]++;
+	}
+
+	if (nthreads == 0 && (nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+		nthreads = 1;
+	if (nthreads > e.nlayouts * e.nmappings)
+		nthreads = e.nlayouts * e.nmappings;
+	e.results = calloc(e.nlayouts * e.nmappings + 1, sizeof(*e.results));
+	threads = malloc(sizeof(*threads) * (nthreads + 1));
+	if (e.results == NULL || threads == NULL)
+		exit(EXIT_FAILURE);
+	pthread_mutex_init(&e.lock, NULL);
+	pthread_mutex_init(&e.gpartlock, NULL);
+	for (j = 0; j < nthreads; j++) {
+		if (pthread_create(&threads[j], NULL, mapeval_thread, &e) != 0) {
+			fprintf(stderr, "Can not create thread\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (j = 0; j < nthreads; j++)
+		pthread_join(threads[j], NULL);
+	pthread_mutex_destroy(&e.lock);
+	pthread_mutex_destroy(&e.gpartlock);
+
+	mapeval_print(&e);
+
+	for (j = 0; j < e.nlayouts; j++)
+		free(e.layouts[j].slots);
+	for (k = 0; k < e.nmappings; k++)
+		free(e.mapfiles[k]);
+	free(e.layouts);
+	free(e.results);
+	free(threads);
+	if (layoutfile != NULL)
+		free(jobnodes);
+	gpart_nettopo_free(e.topo);
+	csrgraph_free(e.g);
+	free(e.g);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*
+ * nettopo.c: Network topology of nodes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpart.h"
+#include "nettopo.h"
+
+static int nettopo_parse_dims(const char *s, int sep, int *dims);
+static int nettopo_load_matrix(gpart_nettopo_t *t, const char *filename);
+
+/* gpart_nettopo_parse: Create topology by description or return NULL. */
+gpart_nettopo_t *gpart_nettopo_parse(const char *desc)
+{
+	gpart_nettopo_t *t;
+	int i, d, v, size;
+
+	if (desc == NULL)
+		return NULL;
+	if ( (t = calloc(1, sizeof(*t))) == NULL)
+		return NULL;
+
+	if (strncmp(desc, "matrix:", 7) == 0) {
+		t->type = GPART_NETTOPO_MATRIX;
+		if (nettopo_load_matrix(t, desc + 7) > 0)
+			goto errhandler;
+		return t;
+	} else if (strncmp(desc, "fattree:", 8) == 0) {
+		t->type = GPART_NETTOPO_FATTREE;
+		t->ndims = nettopo_parse_dims(desc + 8, ',', t->dims);
+	} else if (strncmp(desc, "torus:", 6) == 0) {
+		t->type = GPART_NETTOPO_TORUS;
+		t->ndims = nettopo_parse_dims(desc + 6, 'x', t->dims);
+	} else if (strncmp(desc, "mesh:", 5) == 0) {
+		t->type = GPART_NETTOPO_MESH;
+		t->ndims = nettopo_parse_dims(desc + 5, 'x', t->dims);
+	}
+	if (t->ndims <= 0)
+		goto errhandler;
+
+	for (i = 0, size = 1; i < t->ndims; i++)
+		size *= t->dims[i];
+	t->nnodes = size;
+	if (t->type == GPART_NETTOPO_FATTREE) {
+		/* Links of nodes and of switches below root */
+		t->nlinks = 2 * size;
+		for (d = 0, i = size; d < t->ndims - 1; d++) {
+			i /= t->dims[d];
+			t->nlinks += 2 * i;
+		}
+		t->routemax = 2 * t->ndims;
+	} else {
+		t->nlinks = 2 * t->ndims * size;
+		for (d = 0; d < t->ndims; d++) {
+			t->routemax += (t->type == GPART_NETTOPO_TORUS) ?
+			               t->dims[d] / 2 : t->dims[d] - 1;
+		}
+	}
+	if ( (t->coords = malloc(sizeof(int) * size * t->ndims)) == NULL)
+		goto errhandler;
+
+	for (v = 0; v < size; v++) {
+		if (t->type == GPART_NETTOPO_FATTREE) {
+			/* Switch of level d is node / (a1 * ... * ad) */
+			for (d = 0, i = v; d < t->ndims; d++) {
+				i /= t->dims[d];
+				t->coords[v * t->ndims + d] = i;
+			}
+		} else {
+			/* Row-major order: last dimension changes fastest */
+			for (d = t->ndims - 1, i = v; d >= 0; d--) {
+				t->coords[v * t->ndims + d] = i % t->dims[d];
+				i /= t->dims[d];
+			}
+		}
+	}
+	return t;
+
+errhandler:
+	gpart_nettopo_free(t);
+	return NULL;
+}
+
+/* gpart_nettopo_free: Destroy topology. */
+void gpart_nettopo_free(gpart_nettopo_t *t)
+{
+	if (t) {
+		free(t->coords);
+		free(t->dist);
+		free(t);
+	}
+}
+
+/* gpart_nettopo_distance: Return distance between nodes a and b. */
+int gpart_nettopo_distance(const gpart_nettopo_t *t, int a, int b)
+{
+	const int *ca, *cb;
+	int d, dist, delta;
+
+	if (a == b)
+		return 0;
+	if (t->type == GPART_NETTOPO_MATRIX)
+		return t->dist[a * t->nnodes + b];
+
+	ca = &t->coords[a * t->ndims];
+	cb = &t->coords[b * t->ndims];
+	if (t->type == GPART_NETTOPO_FATTREE) {
+		/* Up to common switch and down */
+		for (d = 0; d < t->ndims; d++) {
+			if (ca[d] == cb[d])
+				return 2 * (d + 1);
+		}
+		return 2 * (t->ndims + 1);
+	}
+
+	for (d = 0, dist = 0; d < t->ndims; d++) {
+		delta = abs(ca[d] - cb[d]);
+		if (t->type == GPART_NETTOPO_TORUS && 2 * delta > t->dims[d])
+			delta = t->dims[d] - delta;
+		dist += delta;
+	}
+	return dist;
+}
+
+/* gpart_nettopo_route: Store links of route from node a to node b. */
+int gpart_nettopo_route(const gpart_nettopo_t *t, int a, int b, int *links)
+{
+	const int *ca, *cb;
+	int strides[GPART_NETTOPO_DIMS_MAX];
+	int d, l, n = 0, base, nswitches, stride, c, next, step, delta;
+
+	if (a == b || t->type == GPART_NETTOPO_MATRIX)
+		return 0;
+
+	ca = &t->coords[a * t->ndims];
+	cb = &t->coords[b * t->ndims];
+	if (t->type == GPART_NETTOPO_FATTREE) {
+		/* Link 2 * i is up, 2 * i + 1 is down; nodes, then switches */
+		for (l = 0; l < t->ndims && ca[l] != cb[l]; l++)
+			;
+		links[n++] = 2 * a;
+		for (d = 0, base = t->nnodes, nswitches = t->nnodes; d < l; d++) {
+			nswitches /= t->dims[d];
+			links[n++] = 2 * (base + ca[d]);
+			base += nswitches;
+		}
+		for (d = l - 1; d >= 0; d--) {
+			base -= nswitches;
+			links[n++] = 2 * (base + cb[d]) + 1;
+			nswitches *= t->dims[d];
+		}
+		links[n++] = 2 * b + 1;
+		return n;
+	}
+
+	for (d = t->ndims - 1, stride = 1; d >= 0; d--) {
+		strides[d] = stride;
+		stride *= t->dims[d];
+	}
+	/* Link 2 * (node * ndims + d) is positive, next is negative */
+	for (d = 0; d < t->ndims; d++) {
+		if ( (delta = cb[d] - ca[d]) == 0)
+			continue;
+		step = delta > 0 ? 1 : -1;
+		if (t->type == GPART_NETTOPO_TORUS && 2 * abs(delta) >= t->dims[d])
+			step = (2 * abs(delta) == t->dims[d]) ? 1 : -step;
+		for (c = ca[d]; c != cb[d]; c = next) {
+			next = (c + step + t->dims[d]) % t->dims[d];
+			links[n++] = 2 * (a * t->ndims + d) + (step < 0);
+			a += (next - c) * strides[d];
+		}
+	}
+	return n;
+}
+
+/* nettopo_parse_dims: Parse list of positive integers; return its length. */
+static int nettopo_parse_dims(const char *s, int sep, int *dims)
+{
+	char *end;
+	int n = 0;
+	long v;
+
+	for (;;) {
+		v = strtol(s, &end, 10);
+		if (end == s || v <= 0 || n == GPART_NETTOPO_DIMS_MAX)
+			return -1;
+		dims[n++] = (int)v;
+		if (*end == '\0')
+			return n;
+		if (*end != sep)
+			return -1;
+		s = end + 1;
+	}
+}
+
+/* nettopo_load_matrix: Read explicit distance matrix. */
+static int nettopo_load_matrix(gpart_nettopo_t *t, const char *filename)
+{
+	FILE *fin;
+	int i, n;
+
+	if ( (fin = fopen(filename, "r")) == NULL)
+		return 1;
+	if (fscanf(fin, "%d", &n) != 1 || n <= 0
+	    || (t->dist = malloc(sizeof(int) * n * n)) == NULL)
+	{
+		fclose(fin);
+		return 1;
+	}
+	for (i = 0; i < n * n; i++) {
+		if (fscanf(fin, "%d", &t->dist[i]) != 1 || t->dist[i] < 0) {
+			fclose(fin);
+			return 1;
+		}
+	}
+	fclose(fin);
+	t->nnodes = n;
+	return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * nettopo.h: Network topology of nodes.
+ *
+ * Topology is described by string:
+ *   fattree:a1,a2,...  - a1 nodes per leaf switch, a2 leaf switches per
+ *                        switch of level 2, ...; distance is number of
+ *                        links on up/down route (2 * level of switch);
+ *   torus:XxYxZ        - torus, nodes in row-major order; distance is
+ *                        number of hops;
+ *   mesh:XxYxZ         - mesh (torus without wraparound links);
+ *   matrix:<file>      - explicit distances: n, then n * n integers.
+ * Nodes of job are nodes 0, 1, ... of topology in order of their numbers.
+ *
+ * Distance oracle is O(1): coordinates of nodes are precomputed and number
+ * of dimensions (levels) is bounded by GPART_NETTOPO_DIMS_MAX.
+ *
+ * Routes are modelled for fat-tree and torus (mesh), matrix has no links:
+ *   fat-tree - up/down routing: up from node to common switch of nodes and
+ *              down to node; every node and every switch except root has
+ *              one link to its parent in each direction;
+ *   torus    - dimension-order routing: dimensions are passed in order,
+ *              in direction of shortest way (positive on tie); every node
+ *              has two links in each dimension (positive and negative).
+ */
+
+#ifndef NETTOPO_H
+#define NETTOPO_H
+
+#include "gpart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPART_NETTOPO_DIMS_MAX 8
+
+enum {
+	GPART_NETTOPO_FATTREE = 1,
+	GPART_NETTOPO_TORUS = 2,
+	GPART_NETTOPO_MESH = 3,
+	GPART_NETTOPO_MATRIX = 4
+};
+
+typedef struct gpart_nettopo gpart_nettopo_t;
+struct gpart_nettopo {
+	int type;
+	int nnodes;
+	int ndims;							/* Fat-tree: levels */
+	int dims[GPART_NETTOPO_DIMS_MAX];	/* Fat-tree: arity of level */
+	int *coords;						/* nnodes * ndims; fat-tree: switch
+										   of node on level */
+	int *dist;							/* Matrix: nnodes * nnodes */
+	int nlinks;							/* Directed links, 0 for matrix */
+	int routemax;						/* Maximal number of links on route */
+};
+
+/* gpart_nettopo_parse: Create topology by description or return NULL. */
+gpart_nettopo_t *gpart_nettopo_parse(const char *desc);
+
+/* gpart_nettopo_free: Destroy topology. */
+void gpart_nettopo_free(gpart_nettopo_t *t);
+
+/* gpart_nettopo_distance: Return distance between nodes a and b. */
+int gpart_nettopo_distance(const gpart_nettopo_t *t, int a, int b);
+
+/*
+ * gpart_nettopo_route: Store links of route from node a to node b in array
+ *                      links of length routemax. Return number of links.
+ */
+int gpart_nettopo_route(const gpart_nettopo_t *t, int a, int b, int *links);
+
+/*
+ * gpart_compute_hopbytes: Return sum of weight times distance over edges;
+ *                         part p is placed on node partnode[p] of topology.
+ */
+edgecut_t gpart_compute_hopbytes(csrgraph_t *g, const int *part,
+                                 const int *partnode,
+                                 const gpart_nettopo_t *t);
+
+/*
+ * gpart_refine_hopbytes:
+ *
+ * k-way refinement of partition of g into nparts parts placed on nodes
+ * partnode[] of topology. Vertices which gain by moving to part of each
+ * other are swapped, so sizes of parts are kept; at most npasses passes.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_refine_hopbytes(csrgraph_t *g, int *part, int nparts,
+                          const int *partnode, const gpart_nettopo_t *t,
+                          int npasses);
+
+/*
+ * gpart_compute_linkloads: Compute loads[nlinks] of links: every edge of g
+ *                          loads route between nodes of parts of its
+ *                          vertices in both directions by its weight.
+ *                          Return maximal load or -1 if topology has no
+ *                          links.
+ */
+long long gpart_compute_linkloads(csrgraph_t *g, const int *part, int nparts,
+                                  const int *partnode,
+                                  const gpart_nettopo_t *t, long long *loads);
+
+/*
+ * gpart_refine_congestion:
+ *
+ * k-way refinement of partition of g into nparts parts placed on nodes
+ * partnode[] of topology: vertices of opposite moves are swapped if swap
+ * does not increase maximal link load and decreases sum of squares of link
+ * loads (loads are updated incrementally by routes of edges of swapped
+ * vertices). At most npasses passes.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_refine_congestion(csrgraph_t *g, int *part, int nparts,
+                            const int *partnode, const gpart_nettopo_t *t,
+                            int npasses);
+
+/*
+ * Traffic between parts of partition: parts adjacent to part p are
+ * adjp[index[p]] .. adjp[index[p + 1] - 1], volume is sum of weights of
+ * edges between parts.
+ */
+typedef struct gpart_traffic gpart_traffic_t;
+struct gpart_traffic {
+	int nparts;
+	int *index;
+	int *adjp;
+	long long *volume;
+};
+
+/* gpart_traffic_build: Build traffic between parts of partition of g. */
+gpart_traffic_t *gpart_traffic_build(csrgraph_t *g, const int *part,
+                                     int nparts);
+
+/* gpart_traffic_free: Destroy traffic between parts. */
+void gpart_traffic_free(gpart_traffic_t *tr);
+
+/*
+ * gpart_assign_nodes:
+ *
+ * Place parts of partition of g on nodes 0 .. nparts - 1 of topology
+ * minimizing hop-bytes: partnode[p] is node of part p. Node q has
+ * partweights[q] slots, so part p is placed only on node with
+ * partweights[p] slots. Parts are placed greedily and pairs of parts
+ * exchange nodes while hop-bytes decrease.
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_assign_nodes(csrgraph_t *g, const int *part, int nparts,
+                       const int *partweights, const gpart_nettopo_t *t,
+                       int *partnode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETTOPO_H */
@@ -0,0 +1,895 @@
+/*
+ * pattern.c: Parametric communication patterns.
+ *
+ * Candidate patterns are generated with weights encoding class of edge
+ * (dimension of grid, step of butterfly, offset of circulant) and merged
+ * with sorted adjacency lists of graph.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "gpart.h"
+#include "pattern.h"
+
+struct pattern_adj {
+	int v, w;
+};
+
+/* Workspace of fitting */
+struct pattern_work {
+	struct pattern_adj *row;	/* Sorted adjacency list of vertex */
+	double *topw;				/* topw[adjindexes[i] + k]: sum of k + 1
+								   heaviest weights of vertex i */
+	int *deg;					/* Degree of vertex without self-loop */
+	double wtotal;
+	double minfit;				/* Candidates below are not scored */
+};
+
+static int pattern_fit(csrgraph_t *g, gpart_pattern_t *pattern,
+                       double minfit);
+static void pattern_try(csrgraph_t *g, gpart_pattern_t *cand,
+                        gpart_pattern_t *best, struct pattern_work *work);
+static void pattern_try_grids(csrgraph_t *g, gpart_pattern_t *cand, int d,
+                              int rest, gpart_pattern_t *best,
+                              struct pattern_work *work);
+static double pattern_bound(csrgraph_t *g, gpart_pattern_t *cand,
+                            struct pattern_work *work);
+static void pattern_fit_complete(csrgraph_t *g, gpart_pattern_t *best);
+static csrgraph_t *pattern_structure(gpart_pattern_t *cand);
+static double pattern_score(csrgraph_t *g, csrgraph_t *c, int nclasses,
+                            double *weights, struct pattern_adj *row);
+static void pattern_fit_circulant(csrgraph_t *g, gpart_pattern_t *best,
+                                  struct pattern_work *work);
+static int pattern_has_edge(csrgraph_t *g, int i, int j);
+static int pattern_bruck_offsets(int nvertices, int *offsets, int *steps);
+static int pattern_is_bruck(gpart_pattern_t *pattern, int *steps);
+static void pattern_loglinear(const double *x, const double *y, int n,
+                              double *a, double *b);
+static void pattern_cut_order(const int *order, int n, const int *partweights,
+                              int *part);
+static void pattern_grid_order(gpart_pattern_t *pattern, int tilesize,
+                               int *order);
+static void pattern_butterfly_order(gpart_pattern_t *pattern, int *order);
+static void pattern_grid_tile(gpart_pattern_t *pattern, int d, int size,
+                              int tilesize, int *tile, int *besttile,
+                              double *bestcost);
+static void pattern_grid_dims(int ndims, int d, int rest, const double *target,
+                              int *dims, int *bestdims, double *bestcost);
+static int pattern_weight(double w);
+static int pattern_adj_cmp(const void *a, const void *b);
+static int pattern_weight_cmp(const void *a, const void *b);
+
+/* gpart_pattern_fit: Find pattern which explains graph g best. */
+int gpart_pattern_fit(csrgraph_t *g, gpart_pattern_t *pattern)
+{
+	/* Best candidate is reported even if it does not fit */
+	return pattern_fit(g, pattern, 0.0);
+}
+
+/* gpart_pattern_detect: Recognize graph which is exactly one of patterns. */
+int gpart_pattern_detect(csrgraph_t *g, gpart_pattern_t *pattern)
+{
+	if (pattern_fit(g, pattern, GPART_PATTERN_FIT_EXACT) != 0)
+		return 1;
+	return (pattern->fit >= GPART_PATTERN_FIT_EXACT) ? 0 : 1;
+}
+
+/*
+ * pattern_fit: Find pattern which explains graph g best. Candidates which
+ *              cannot reach minfit or fit of best candidate by degrees and
+ *              weights of graph are not generated.
+ */
+static int pattern_fit(csrgraph_t *g, gpart_pattern_t *pattern, double minfit)
+{
+	gpart_pattern_t cand;
+	struct pattern_work work;
+	double *w;
+	int i, j, deg, degmax, nsteps, rc = 1;
+
+	memset(pattern, 0, sizeof(*pattern));
+	pattern->type = GPART_PATTERN_NONE;
+	if (g == NULL || g->nvertices < 2)
+		return 1;
+	pattern->nvertices = g->nvertices;
+
+	for (i = 0, degmax = 0; i < g->nvertices; i++) {
+		deg = g->adjindexes[i + 1] - g->adjindexes[i];
+		if (deg > degmax)
+			degmax = deg;
+	}
+	work.row = malloc(sizeof(*work.row) * (degmax + 1));
+	work.topw = malloc(sizeof(*work.topw) * (g->adjindexes[g->nvertices] + 1));
+	work.deg = malloc(sizeof(*work.deg) * g->nvertices);
+	if (work.row == NULL || work.topw == NULL || work.deg == NULL)
+		goto errhandler;
+
+	/* Prefix sums of weights sorted in descending order */
+	work.wtotal = 0;
+	work.minfit = minfit;
+	for (i = 0; i < g->nvertices; i++) {
+		w = work.topw + g->adjindexes[i];
+		for (j = g->adjindexes[i], deg = 0; j < g->adjindexes[i + 1]; j++) {
+			if (g->adjv[j] != i)
+				w[deg++] = g->edges[j];
+		}
+		qsort(w, deg, sizeof(*w), pattern_weight_cmp);
+		for (j = 1; j < deg; j++)
+			w[j] += w[j - 1];
+		work.deg[i] = deg;
+		work.wtotal += (deg > 0) ? w[deg - 1] : 0;
+	}
+
+	pattern_fit_complete(g, pattern);
+
+	/* Rings and chains, 2D and 3D stencils */
+	for (i = 1; i <= GPART_PATTERN_DIMS_MAX; i++) {
+		memset(&cand, 0, sizeof(cand));
+		cand.type = GPART_PATTERN_GRID;
+		cand.nvertices = g->nvertices;
+		cand.ndims = i;
+		cand.nclasses = i;
+		pattern_try_grids(g, &cand, i - 1, 1, pattern, &work);
+	}
+
+	memset(&cand, 0, sizeof(cand));
+	cand.type = GPART_PATTERN_TREE;
+	cand.nvertices = g->nvertices;
+	cand.nclasses = 1;
+	pattern_try(g, &cand, pattern, &work);
+
+	for (nsteps = 0; (1 << nsteps) < g->nvertices; nsteps++)
+		;
+	memset(&cand, 0, sizeof(cand));
+	cand.type = GPART_PATTERN_BUTTERFLY;
+	cand.nvertices = g->nvertices;
+	cand.nclasses = nsteps;
+	pattern_try(g, &cand, pattern, &work);
+
+	pattern_fit_circulant(g, pattern, &work);
+
+	rc = (pattern->fit >= GPART_PATTERN_FIT_MIN) ? 0 : 1;
+
+errhandler:
+	free(work.row);
+	free(work.topw);
+	free(work.deg);
+	return rc;
+}
+
+/* gpart_pattern_partition: Partition graph of pattern in closed form. */
+int gpart_pattern_partition(csrgraph_t *g, gpart_pattern_t *pattern,
+                            int *partweights, int nparts, int *part)
+{
+	int *order, *tmp = NULL, i, k, t, n = pattern->nvertices;
+	edgecut_t cut, bestcut;
+
+	for (i = 0, k = 0; i < nparts; i++) {
+		if (partweights[i] < 0)
+			return 1;
+		k += partweights[i];
+	}
+	if (nparts < 1 || k != n)
+		return 1;
+
+	/* Offsets 2^k are multiples of stride only if nparts is power of 2 */
+	if (pattern_is_bruck(pattern, NULL) && (nparts & (nparts - 1)) != 0)
+		return 1;
+
+	if ( (order = malloc(sizeof(*order) * n)) == NULL)
+		return 1;
+
+	switch (pattern->type) {
+	case GPART_PATTERN_GRID:
+		pattern_grid_order(pattern, (n + nparts / 2) / nparts, order);
+		break;
+	case GPART_PATTERN_BUTTERFLY:
+		pattern_butterfly_order(pattern, order);
+		break;
+	default:
+		for (i = 0; i < n; i++)
+			order[i] = i;
+	}
+	pattern_cut_order(order, n, partweights, part);
+
+	/*
+	 * Circulant: blocks of vertices v, v + t, v + 2t, ... keep heavy
+	 * offsets (multiples of t) inside; best stride t is chosen by edge-cut.
+	 */
+	if (pattern->type == GPART_PATTERN_CIRCULANT && g != NULL
+	    && g->nvertices == n && (tmp = malloc(sizeof(*tmp) * n)) != NULL)
+	{
+		bestcut = gpart_compute_edgecut(g, part);
+		for (t = 2; t < n; t++) {
+			if (n % t != 0)
+				continue;
+			for (i = 0; i < n; i++)
+				order[i] = (i % (n / t)) * t + i / (n / t);
+			pattern_cut_order(order, n, partweights, tmp);
+			if ( (cut = gpart_compute_edgecut(g, tmp)) < bestcut) {
+				bestcut = cut;
+				memcpy(part, tmp, sizeof(*part) * n);
+			}
+		}
+		free(tmp);
+	}
+	free(order);
+	return 0;
+}
+
+/*
+ * gpart_pattern_generate: Synthesize graph of pattern with nvertices
+ *                         vertices; weights are scaled by scaling rule.
+ */
+csrgraph_t *gpart_pattern_generate(gpart_pattern_t *pattern, int nvertices,
+                                   int scaling)
+{
+	double ratio, target[GPART_PATTERN_DIMS_MAX], cost, w, a, b;
+	double x[GPART_PATTERN_CLASSES_MAX], y[GPART_PATTERN_CLASSES_MAX];
+	int dims[GPART_PATTERN_DIMS_MAX], newdims[GPART_PATTERN_DIMS_MAX];
+	int weights[GPART_PATTERN_CLASSES_MAX], offsets[GPART_PATTERN_CLASSES_MAX];
+	int steps[GPART_PATTERN_CLASSES_MAX];
+	int d, k, m, nsteps;
+
+	if (pattern == NULL || nvertices < 2 || pattern->nvertices < 1)
+		return NULL;
+	ratio = (double)pattern->nvertices / nvertices;
+
+	switch (pattern->type) {
+	case GPART_PATTERN_GRID:
+		if (pattern->ndims < 1 || pattern->ndims > GPART_PATTERN_DIMS_MAX)
+			return NULL;
+
+		/* Keep aspect ratio of grid */
+		for (d = 0; d < pattern->ndims; d++) {
+			target[d] = pattern->dims[d] * pow(1.0 / ratio,
+			                                   1.0 / pattern->ndims);
+			newdims[d] = 1;
+		}
+		newdims[pattern->ndims - 1] = nvertices;
+		cost = HUGE_VAL;
+		pattern_grid_dims(pattern->ndims, 0, nvertices, target, dims,
+		                  newdims, &cost);
+
+		/* Face of dimension d is product of local extents in others */
+		for (d = 0; d < pattern->ndims; d++) {
+			w = pattern->weights[d];
+			for (k = 0; k < pattern->ndims && scaling == GPART_SCALING_STRONG;
+			     k++)
+			{
+				if (k != d)
+					w *= (double)pattern->dims[k] / newdims[k];
+			}
+			weights[d] = pattern_weight(w);
+		}
+		return csrgraph_generate_grid(pattern->ndims, newdims,
+		                              pattern->periodic, weights);
+
+	case GPART_PATTERN_TREE:
+		return csrgraph_generate_tree(nvertices,
+		                              pattern_weight(pattern->weights[0]));
+
+	case GPART_PATTERN_BUTTERFLY:
+		/* Log-linear fit of step weights: w_k = exp(a + b * k) */
+		for (k = 0, m = 0; k < pattern->nclasses; k++) {
+			if (pattern->weights[k] > 0) {
+				x[m] = k;
+				y[m++] = pattern->weights[k];
+			}
+		}
+		if (m == 0)
+			return NULL;
+		pattern_loglinear(x, y, m, &a, &b);
+
+		for (nsteps = 0; (1 << nsteps) < nvertices; nsteps++)
+			;
+		for (k = 0; k < nsteps && k < GPART_PATTERN_CLASSES_MAX; k++) {
+			if (k < pattern->nclasses && pattern->weights[k] > 0)
+				w = pattern->weights[k];
+			else
+				w = exp(a + b * k);
+			if (scaling == GPART_SCALING_STRONG)
+				w *= ratio;
+			weights[k] = pattern_weight(w);
+		}
+		return csrgraph_generate_butterfly(nvertices, weights);
+
+	case GPART_PATTERN_CIRCULANT:
+		/* Offsets 2^k of Bruck's algorithm grow with graph */
+		if (pattern_is_bruck(pattern, steps)) {
+			for (k = 0, m = 0; k < pattern->nclasses; k++) {
+				if (pattern->weights[k] > 0) {
+					x[m] = steps[k];
+					y[m++] = pattern->weights[k];
+				}
+			}
+			if (m == 0)
+				return NULL;
+			pattern_loglinear(x, y, m, &a, &b);
+
+			for (nsteps = 0; (1 << nsteps) < nvertices; nsteps++)
+				;
+			for (k = 0; k < nsteps && k < GPART_PATTERN_CLASSES_MAX; k++) {
+				offsets[k] = 1 << k;
+				for (d = 0; d < pattern->nclasses; d++) {
+					if (steps[d] == k)
+						break;
+				}
+				if (d < pattern->nclasses && pattern->weights[d] > 0)
+					w = pattern->weights[d];
+				else
+					w = exp(a + b * k);
+				if (scaling == GPART_SCALING_STRONG)
+					w *= ratio;
+				weights[k] = pattern_weight(w);
+			}
+			return csrgraph_generate_circulant(nvertices, k, offsets,
+			                                   weights);
+		}
+
+		/* Other offsets are kept (halo of 1D decomposition) */
+		for (k = 0, m = 0; k < pattern->nclasses; k++) {
+			if (2 * pattern->offsets[k] <= nvertices) {
+				offsets[m] = pattern->offsets[k];
+				weights[m++] = pattern_weight(pattern->weights[k]);
+			}
+		}
+		return csrgraph_generate_circulant(nvertices, m, offsets, weights);
+
+	case GPART_PATTERN_COMPLETE:
+		w = pattern->weights[0];
+		if (scaling == GPART_SCALING_STRONG)
+			w *= ratio * ratio;
+		return csrgraph_generate_complete(nvertices, pattern_weight(w));
+	}
+	return NULL;
+}
+
+/* gpart_pattern_name: Return name of pattern type. */
+const char *gpart_pattern_name(int type)
+{
+	switch (type) {
+	case GPART_PATTERN_GRID:
+		return "grid";
+	case GPART_PATTERN_TREE:
+		return "tree";
+	case GPART_PATTERN_BUTTERFLY:
+		return "butterfly";
+	case GPART_PATTERN_COMPLETE:
+		return "complete";
+	case GPART_PATTERN_CIRCULANT:
+		return "circulant";
+	}
+	return "none";
+}
+
+/* gpart_pattern_scaling: Return scaling by name (weak, strong) or -1. */
+int gpart_pattern_scaling(const char *name)
+{
+	if (name == NULL || strcmp(name, "weak") == 0)
+		return GPART_SCALING_WEAK;
+	else if (strcmp(name, "strong") == 0)
+		return GPART_SCALING_STRONG;
+	return -1;
+}
+
+/* gpart_pattern_print: Print pattern parameters. */
+void gpart_pattern_print(gpart_pattern_t *pattern, FILE *fout)
+{
+	int i;
+
+	fprintf(fout, "%s", gpart_pattern_name(pattern->type));
+	if (pattern->type == GPART_PATTERN_GRID) {
+		for (i = 0; i < pattern->ndims; i++) {
+			fprintf(fout, "%c%d%s", (i == 0) ? ' ' : 'x', pattern->dims[i],
+			        pattern->periodic[i] ? "p" : "");
+		}
+	} else if (pattern->type == GPART_PATTERN_CIRCULANT) {
+		for (i = 0; i < pattern->nclasses; i++)
+			fprintf(fout, "%c%d", (i == 0) ? ' ' : ',', pattern->offsets[i]);
+	}
+	fprintf(fout, " (fit %.3f), weights:", pattern->fit);
+	for (i = 0; i < pattern->nclasses; i++)
+		fprintf(fout, " %.0f", pattern->weights[i]);
+	fprintf(fout, "\n");
+}
+
+/* pattern_try: Evaluate candidate and keep it if it is better than best. */
+static void pattern_try(csrgraph_t *g, gpart_pattern_t *cand,
+                        gpart_pattern_t *best, struct pattern_work *work)
+{
+	csrgraph_t *c;
+	double bound;
+
+	/* Irregular graph cannot fit: candidate graph is not generated */
+	bound = pattern_bound(g, cand, work);
+	if (bound < work->minfit || bound < best->fit - 1E-9)
+		return;
+	if ( (c = pattern_structure(cand)) == NULL)
+		return;
+	cand->fit = pattern_score(g, c, cand->nclasses, cand->weights,
+	                          work->row);
+	csrgraph_free(c);
+	free(c);
+
+	/* Simpler pattern wins on tie */
+	if (cand->fit > best->fit + 1E-9)
+		*best = *cand;
+}
+
+/*
+ * pattern_try_grids: Try grids with dimensions d, d - 1, ..., 0 left to
+ *                    choose (every dimension >= 2); stride is product of
+ *                    dimensions d + 1, ..., ndims - 1. Vertex 0 is linked
+ *                    with vertex stride in every grid, so only neighbors of
+ *                    vertex 0 are tried as strides. Dimension is periodic
+ *                    if graph has wraparound edge at vertex 0.
+ */
+static void pattern_try_grids(csrgraph_t *g, gpart_pattern_t *cand, int d,
+                              int stride, gpart_pattern_t *best,
+                              struct pattern_work *work)
+{
+	int j, k, u, n = g->nvertices;
+
+	if (!pattern_has_edge(g, 0, stride))
+		return;
+	if (d == 0) {
+		if (n % stride != 0 || n / stride < 2
+		    || (cand->ndims == 1 && n < 3))
+		{
+			return;
+		}
+		cand->dims[0] = n / stride;
+		for (k = cand->ndims - 1, stride = 1; k >= 0; k--) {
+			cand->periodic[k] = cand->dims[k] > 2
+			    && pattern_has_edge(g, 0, (cand->dims[k] - 1) * stride);
+			stride *= cand->dims[k];
+		}
+		pattern_try(g, cand, best, work);
+		return;
+	}
+	for (j = g->adjindexes[0]; j < g->adjindexes[1]; j++) {
+		u = g->adjv[j];
+		if (u >= 2 * stride && u % stride == 0 && n % u == 0) {
+			cand->dims[d] = u / stride;
+			pattern_try_grids(g, cand, d - 1, u, best, work);
+		}
+	}
+}
+
+/* pattern_fit_complete: Fit all-to-all without building complete graph. */
+static void pattern_fit_complete(csrgraph_t *g, gpart_pattern_t *best)
+{
+	double wtotal = 0;
+	long long nadj = 0;
+	int i, k;
+
+	for (i = 0; i < g->nvertices; i++) {
+		for (k = g->adjindexes[i]; k < g->adjindexes[i + 1]; k++) {
+			if (g->adjv[k] != i) {
+				wtotal += g->edges[k];
+				nadj++;
+			}
+		}
+	}
+	if (nadj == 0)
+		return;
+	best->type = GPART_PATTERN_COMPLETE;
+	best->nclasses = 1;
+	best->weights[0] = wtotal / nadj;
+	best->fit = (double)nadj / ((double)g->nvertices * (g->nvertices - 1));
+	if (best->fit > 1.0)
+		best->fit = 1.0;
+}
+
+/*
+ * pattern_bound: Upper bound of fit of candidate in O(n): vertex of
+ *                candidate with at most degmax neighbors matches at most
+ *                min(deg, degmax) edges of graph, which weigh at most as
+ *                its degmax heaviest edges. Number of edges of candidate
+ *                is counted in closed form (lower bound).
+ */
+static double pattern_bound(csrgraph_t *g, gpart_pattern_t *cand,
+                            struct pattern_work *work)
+{
+	double wmatched = 0;
+	long long nboth = 0, ncand = 0;
+	int i, k, v, degmax, n = g->nvertices;
+
+	switch (cand->type) {
+	case GPART_PATTERN_GRID:
+		for (k = 0; k < cand->ndims; k++) {
+			ncand += 2LL * (n / cand->dims[k])
+			         * (cand->dims[k] - 1 + (cand->periodic[k] ? 1 : 0));
+		}
+		degmax = 2 * cand->ndims;
+		break;
+	case GPART_PATTERN_TREE:
+		for (k = 0; (1 << k) < n; k++)
+			;
+		ncand = 2LL * (n - 1);
+		degmax = k + 1;
+		break;
+	case GPART_PATTERN_BUTTERFLY:
+		for (k = 0; k < cand->nclasses; k++) {
+			for (v = 0; v < n; v++)
+				ncand += ((v ^ (1 << k)) < n);
+		}
+		degmax = cand->nclasses;
+		break;
+	case GPART_PATTERN_CIRCULANT:
+		for (k = 0; k < cand->nclasses; k++)
+			ncand += (long long)n * ((2 * cand->offsets[k] == n) ? 1 : 2);
+		degmax = 2 * cand->nclasses;
+		break;
+	default:
+		return 1.0;
+	}
+	if (work->wtotal <= 0 || ncand == 0)
+		return 0.0;
+
+	for (i = 0; i < n; i++) {
+		k = (work->deg[i] < degmax) ? work->deg[i] : degmax;
+		if (k > 0) {
+			wmatched += work->topw[g->adjindexes[i] + k - 1];
+			nboth += k;
+		}
+	}
+	if (nboth > ncand)
+		nboth = ncand;
+	return (wmatched / work->wtotal) * ((double)nboth / ncand);
+}
+
+/* pattern_structure: Generate candidate graph, weight is class + 1. */
+static csrgraph_t *pattern_structure(gpart_pattern_t *cand)
+{
+	int classes[GPART_PATTERN_CLASSES_MAX], i;
+
+	for (i = 0; i < GPART_PATTERN_CLASSES_MAX; i++)
+		classes[i] = i + 1;
+
+	switch (cand->type) {
+	case GPART_PATTERN_GRID:
+		return csrgraph_generate_grid(cand->ndims, cand->dims,
+		                              cand->periodic, classes);
+	case GPART_PATTERN_TREE:
+		return csrgraph_generate_tree(cand->nvertices, 1);
+	case GPART_PATTERN_BUTTERFLY:
+		return csrgraph_generate_butterfly(cand->nvertices, classes);
+	case GPART_PATTERN_CIRCULANT:
+		return csrgraph_generate_circulant(cand->nvertices, cand->nclasses,
+		                                   cand->offsets, classes);
+	}
+	return NULL;
+}
+
+/*
+ * pattern_score: Compare graph g with candidate c and compute mean weights
+ *                of edge classes.
+ */
+static double pattern_score(csrgraph_t *g, csrgraph_t *c, int nclasses,
+                            double *weights, struct pattern_adj *row)
+{
+	double wtotal = 0, wmatched = 0, sum[GPART_PATTERN_CLASSES_MAX];
+	long long count[GPART_PATTERN_CLASSES_MAX], nboth = 0, ncand;
+	int i, j, k, kend, deg, cls;
+
+	for (i = 0; i < nclasses; i++) {
+		sum[i] = 0;
+		count[i] = 0;
+	}
+	for (i = 0; i < g->nvertices; i++) {
+		deg = g->adjindexes[i + 1] - g->adjindexes[i];
+		for (j = 0; j < deg; j++) {
+			row[j].v = g->adjv[g->adjindexes[i] + j];
+			row[j].w = g->edges[g->adjindexes[i] + j];
+		}
+		qsort(row, deg, sizeof(*row), pattern_adj_cmp);
+
+		k = c->adjindexes[i];
+		kend = c->adjindexes[i + 1];
+		for (j = 0; j < deg; j++) {
+			if (row[j].v == i)
+				continue;
+			wtotal += row[j].w;
+			while (k < kend && c->adjv[k] < row[j].v)
+				k++;
+			if (k < kend && c->adjv[k] == row[j].v) {
+				cls = c->edges[k] - 1;
+				wmatched += row[j].w;
+				sum[cls] += row[j].w;
+				count[cls]++;
+				nboth++;
+				k++;
+			}
+		}
+	}
+	ncand = c->adjindexes[c->nvertices];
+	for (i = 0; i < nclasses; i++)
+		weights[i] = (count[i] > 0) ? sum[i] / count[i] : 0.0;
+	if (wtotal <= 0 || ncand == 0)
+		return 0.0;
+	return (wmatched / wtotal) * ((double)nboth / ncand);
+}
+
+static int pattern_has_edge(csrgraph_t *g, int i, int j)
+{
+	int k;
+
+	for (k = g->adjindexes[i]; k < g->adjindexes[i + 1]; k++) {
+		if (g->adjv[k] == j)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * pattern_grid_dims: Find factorization of rest into dimensions with minimal
+ *                    sum of squared log deviations from target extents.
+ */
+static void pattern_grid_dims(int ndims, int d, int rest, const double *target,
+                              int *dims, int *bestdims, double *bestcost)
+{
+	double cost;
+	int f, k;
+
+	if (d == ndims - 1) {
+		dims[d] = rest;
+		for (k = 0, cost = 0; k < ndims; k++)
+			cost += pow(log(dims[k] / target[k]), 2);
+		if (cost < *bestcost) {
+			*bestcost = cost;
+			memcpy(bestdims, dims, sizeof(*dims) * ndims);
+		}
+		return;
+	}
+	for (f = 1; f <= rest; f++) {
+		if (rest % f == 0) {
+			dims[d] = f;
+			pattern_grid_dims(ndims, d + 1, rest / f, target, dims, bestdims,
+			                  bestcost);
+		}
+	}
+}
+
+/*
+ * pattern_fit_circulant: Fit circulant graph with offsets taken from
+ *                        adjacency list of vertex 0.
+ */
+static void pattern_fit_circulant(csrgraph_t *g, gpart_pattern_t *best,
+                                  struct pattern_work *work)
+{
+	gpart_pattern_t cand;
+	int j, k, s, n = g->nvertices;
+
+	memset(&cand, 0, sizeof(cand));
+	cand.type = GPART_PATTERN_CIRCULANT;
+	cand.nvertices = n;
+	for (j = g->adjindexes[0]; j < g->adjindexes[1]; j++) {
+		s = g->adjv[j];
+		if (s == 0)
+			continue;
+		if (2 * s > n)
+			s = n - s;
+
+		/* Insert offset into sorted list */
+		for (k = cand.nclasses; k > 0 && cand.offsets[k - 1] > s; k--)
+			;
+		if (k > 0 && cand.offsets[k - 1] == s)
+			continue;
+		if (cand.nclasses == GPART_PATTERN_CLASSES_MAX)
+			return;
+		memmove(&cand.offsets[k + 1], &cand.offsets[k],
+		        sizeof(cand.offsets[0]) * (cand.nclasses - k));
+		cand.offsets[k] = s;
+		cand.nclasses++;
+	}
+	if (cand.nclasses > 0)
+		pattern_try(g, &cand, best, work);
+}
+
+/*
+ * pattern_bruck_offsets: Sorted distinct offsets (<= n / 2) of Bruck's
+ *                        algorithm graph and step k of every offset.
+ *                        Return number of offsets.
+ */
+static int pattern_bruck_offsets(int nvertices, int *offsets, int *steps)
+{
+	int k, i, j, s, m = 0;
+
+	for (k = 0; k < GPART_PATTERN_CLASSES_MAX && (1 << k) < nvertices; k++) {
+		s = (1 << k) % nvertices;
+		if (2 * s > nvertices)
+			s = nvertices - s;
+		for (i = 0; i < m && offsets[i] < s; i++)
+			;
+		if (i < m && offsets[i] == s)
+			continue;
+		for (j = m; j > i; j--) {
+			offsets[j] = offsets[j - 1];
+			steps[j] = steps[j - 1];
+		}
+		offsets[i] = s;
+		steps[i] = k;
+		m++;
+	}
+	return m;
+}
+
+/*
+ * pattern_is_bruck: Check that circulant has offsets of Bruck's algorithm,
+ *                   steps of offsets are returned in steps (may be NULL).
+ */
+static int pattern_is_bruck(gpart_pattern_t *pattern, int *steps)
+{
+	int offsets[GPART_PATTERN_CLASSES_MAX], s[GPART_PATTERN_CLASSES_MAX];
+	int k, m;
+
+	if (pattern->type != GPART_PATTERN_CIRCULANT)
+		return 0;
+	m = pattern_bruck_offsets(pattern->nvertices, offsets, s);
+	if (m != pattern->nclasses)
+		return 0;
+	for (k = 0; k < m; k++) {
+		if (offsets[k] != pattern->offsets[k])
+			return 0;
+	}
+	if (steps != NULL)
+		memcpy(steps, s, sizeof(*s) * m);
+	return 1;
+}
+
+/* pattern_loglinear: Least squares fit of y = exp(a + b * x). */
+static void pattern_loglinear(const double *x, const double *y, int n,
+                              double *a, double *b)
+{
+	double sx = 0, sy = 0, sxx = 0, sxy = 0, d;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		sx += x[i];
+		sy += log(y[i]);
+		sxx += x[i] * x[i];
+		sxy += x[i] * log(y[i]);
+	}
+	d = n * sxx - sx * sx;
+	*b = (n > 1 && fabs(d) > 1E-12) ? (n * sxy - sx * sy) / d : 0.0;
+	*a = (sy - *b * sx) / n;
+}
+
+/*
+ * pattern_grid_order: Order vertices of grid tile by tile; tiles and
+ *                     vertices of tile are in row-major order.
+ */
+static void pattern_grid_order(gpart_pattern_t *pattern, int tilesize,
+                               int *order)
+{
+	int tile[GPART_PATTERN_DIMS_MAX], besttile[GPART_PATTERN_DIMS_MAX];
+	int ntiles[GPART_PATTERN_DIMS_MAX], i, d, t, l, v, stride, size;
+	double cost = HUGE_VAL;
+
+	for (d = 0; d < pattern->ndims; d++)
+		besttile[d] = 1;
+	pattern_grid_tile(pattern, 0, 1, tilesize, tile, besttile, &cost);
+	for (d = 0, size = 1; d < pattern->ndims; d++) {
+		ntiles[d] = pattern->dims[d] / besttile[d];
+		size *= besttile[d];
+	}
+
+	for (i = 0; i < pattern->nvertices; i++) {
+		t = i / size;
+		l = i % size;
+		for (d = pattern->ndims - 1, v = 0, stride = 1; d >= 0; d--) {
+			v += ((t % ntiles[d]) * besttile[d] + l % besttile[d]) * stride;
+			t /= ntiles[d];
+			l /= besttile[d];
+			stride *= pattern->dims[d];
+		}
+		order[i] = v;
+	}
+}
+
+/*
+ * pattern_butterfly_order: Order vertices so that bits of heaviest steps
+ *                          change fastest: aligned blocks of order are
+ *                          subcubes spanned by heaviest steps.
+ */
+static void pattern_butterfly_order(gpart_pattern_t *pattern, int *order)
+{
+	int bits[GPART_PATTERN_CLASSES_MAX], i, j, k, v, n = pattern->nvertices;
+
+	/* Steps by weight in decreasing order, later step wins on tie */
+	for (k = 0; k < pattern->nclasses; k++) {
+		for (j = k; j > 0 && pattern->weights[bits[j - 1]]
+		                     <= pattern->weights[pattern->nclasses - 1 - k]; j--)
+		{
+			bits[j] = bits[j - 1];
+		}
+		bits[j] = pattern->nclasses - 1 - k;
+	}
+
+	for (i = 0, j = 0; j < n; i++) {
+		for (k = 0, v = 0; k < pattern->nclasses; k++) {
+			if (i & (1 << k))
+				v |= 1 << bits[k];
+		}
+		if (v < n)
+			order[j++] = v;
+	}
+}
+
+/* pattern_cut_order: Cut order into consecutive blocks of partweights. */
+static void pattern_cut_order(const int *order, int n, const int *partweights,
+                              int *part)
+{
+	int i, j, k;
+
+	for (i = 0, j = 0, k = 0; i < n; i++) {
+		while (k == partweights[j]) {
+			j++;
+			k = 0;
+		}
+		part[order[i]] = j;
+		k++;
+	}
+}
+
+/*
+ * pattern_grid_tile: Find tile (extents divide dimensions of grid) with
+ *                    largest size not greater than tilesize and minimal
+ *                    weighted surface: sum of weights[d] * size / tile[d].
+ */
+static void pattern_grid_tile(gpart_pattern_t *pattern, int d, int size,
+                              int tilesize, int *tile, int *besttile,
+                              double *bestcost)
+{
+	double cost;
+	int f, k, bestsize;
+
+	if (d == pattern->ndims) {
+		/* Prefer larger tiles, surface breaks ties */
+		for (k = 0, cost = 0, bestsize = 1; k < pattern->ndims; k++) {
+			if (tile[k] < pattern->dims[k])
+				cost += pattern->weights[k] * size / tile[k];
+			bestsize *= besttile[k];
+		}
+		if (size > bestsize || (size == bestsize && cost < *bestcost)) {
+			*bestcost = cost;
+			memcpy(besttile, tile, sizeof(*tile) * pattern->ndims);
+		}
+		return;
+	}
+	for (f = 1; f <= pattern->dims[d] && size * f <= tilesize; f++) {
+		if (pattern->dims[d] % f == 0) {
+			tile[d] = f;
+			pattern_grid_tile(pattern, d + 1, size * f, tilesize, tile,
+			                  besttile, bestcost);
+		}
+	}
+}
+
+/* pattern_weight: Round weight to int in [1, INT_MAX]. */
+static int pattern_weight(double w)
+{
+	if (w >= INT_MAX)
+		return INT_MAX;
+	return (w < 1.0) ? 1 : (int)floor(w + 0.5);
+}
+
+static int pattern_adj_cmp(const void *a, const void *b)
+{
+	const struct pattern_adj *x = a, *y = b;
+
+	return (x->v > y->v) - (x->v < y->v);
+}
+
+/* pattern_weight_cmp: Descending order of weights. */
+static int pattern_weight_cmp(const void *a, const void *b)
+{
+	const double *x = a, *y = b;
+
+	return (*x < *y) - (*x > *y);
+}
@@ -0,0 +1,122 @@
+/*
+ * pattern.h: Parametric communication patterns.
+ *
+ * Graph is fitted to one of common patterns (Cartesian stencil, ring,
+ * binomial tree, butterfly, all-to-all, circulant); fitted pattern can
+ * synthesize graph with other number of vertices (extrapolation of profile
+ * to larger job size) and partition graph in closed form.
+ */
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <stdio.h>
+
+#include "gpart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPART_PATTERN_DIMS_MAX     3
+#define GPART_PATTERN_CLASSES_MAX  31
+#define GPART_PATTERN_FIT_MIN      0.9
+#define GPART_PATTERN_FIT_EXACT    0.99
+
+enum {
+	GPART_PATTERN_NONE = 0,
+	GPART_PATTERN_GRID = 1,			/* Cartesian stencil, ring is 1D grid */
+	GPART_PATTERN_TREE = 2,			/* Binomial tree rooted at 0 */
+	GPART_PATTERN_BUTTERFLY = 3,	/* Hypercube: v <-> v xor 2^k */
+	GPART_PATTERN_COMPLETE = 4,		/* All-to-all */
+	GPART_PATTERN_CIRCULANT = 5		/* v <-> v +- offset (mod n), Bruck */
+};
+
+/*
+ * Scaling of weights:
+ *   weak   - work per process is fixed: weights of grid, tree and complete
+ *            graph are kept, weights of butterfly steps are extrapolated;
+ *   strong - total work is fixed: grid faces shrink with local subdomain,
+ *            butterfly volumes scale by n / P, all-to-all by (n / P)^2,
+ *            tree weights are kept.
+ */
+enum {
+	GPART_SCALING_WEAK = 0,
+	GPART_SCALING_STRONG = 1
+};
+
+typedef struct gpart_pattern gpart_pattern_t;
+struct gpart_pattern {
+	int type;
+	int nvertices;
+	int ndims;							/* Grid */
+	int dims[GPART_PATTERN_DIMS_MAX];
+	int periodic[GPART_PATTERN_DIMS_MAX];
+	int nclasses;						/* Grid: ndims, butterfly: steps,
+										   circulant: offsets */
+	int offsets[GPART_PATTERN_CLASSES_MAX];		/* Circulant, <= n / 2 */
+	double weights[GPART_PATTERN_CLASSES_MAX];	/* Mean weight of class */
+	double fit;							/* Share of graph explained, 0..1 */
+};
+
+/*
+ * gpart_pattern_fit: Find pattern which explains graph g best.
+ *                    Fit is share of edge weight on pattern edges times
+ *                    share of pattern edges present in graph. Candidates
+ *                    whose bound by degrees and heaviest edges of vertices
+ *                    is below fit of best one are not generated.
+ *                    Return 0 if fit >= GPART_PATTERN_FIT_MIN, 1 otherwise.
+ */
+int gpart_pattern_fit(csrgraph_t *g, gpart_pattern_t *pattern);
+
+/*
+ * gpart_pattern_detect: Recognize graph which is exactly one of patterns
+ *                       (fit >= GPART_PATTERN_FIT_EXACT). Candidates
+ *                       with bound below GPART_PATTERN_FIT_EXACT are
+ *                       skipped, so irregular graphs are rejected without
+ *                       generating candidate graphs.
+ *                       Return 0 if graph is recognized, 1 otherwise.
+ */
+int gpart_pattern_detect(csrgraph_t *g, gpart_pattern_t *pattern);
+
+/*
+ * gpart_pattern_partition: Partition graph of pattern in closed form, O(n);
+ *                          circulant computes edge-cut of g for every
+ *                          divisor of n, O(d(n) * E).
+ *
+ * Vertices are ordered by locality and order is cut into consecutive
+ * blocks of partweights[0], partweights[1], ... vertices:
+ *   grid      - tiles of shape with minimal weighted surface;
+ *   butterfly - bits of heaviest steps change fastest (blocks are subcubes);
+ *   circulant - vertices v, v + t, v + 2t, ..., stride t with minimal
+ *               edge-cut of graph g is chosen (g may be NULL); graph of
+ *               Bruck's algorithm is partitioned only if nparts is power
+ *               of 2;
+ *   others    - natural order (blocks of binomial tree are subtrees).
+ *
+ * Return 0 on success and 1 otherwise.
+ */
+int gpart_pattern_partition(csrgraph_t *g, gpart_pattern_t *pattern,
+                            int *partweights, int nparts, int *part);
+
+/*
+ * gpart_pattern_generate: Synthesize graph of pattern with nvertices
+ *                         vertices; weights are scaled by scaling rule.
+ */
+csrgraph_t *gpart_pattern_generate(gpart_pattern_t *pattern, int nvertices,
+                                   int scaling);
+
+/* gpart_pattern_name: Return name of pattern type. */
+const char *gpart_pattern_name(int type);
+
+/* gpart_pattern_scaling: Return scaling by name (weak, strong) or -1. */
+int gpart_pattern_scaling(const char *name);
+
+/* gpart_pattern_print: Print pattern parameters. */
+void gpart_pattern_print(gpart_pattern_t *pattern, FILE *fout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PATTERN_H */
@@ -101,6 +101,7 @@ static int fm_hashtab_get_maxgain_vertex(fm_hashtab_t *b);
 
 /*
  * gpart_refine_bisection_fm: Refine bisection by Fiduccia-Mattheyses heuristic.
+ *                            Fixed vertices (g->vfixed) are not moved.
  *                            Return edge-cut in edgecut.
  *                            Return 0 on success and 1 otherwise.
  */
@@ -200,9 +201,14 @@ int gpart_refine_bisection_fm(csrgraph_t *g, int *bisection, int *partsizes,
 	if (vwavg > tmp)
 		vwavg = tmp;
 
+	/* Fixed vertices are locked */
 	edgecut_best = *edgecut;
-	for (i = 0; i < nvertices; i++)
-		vertices_moves[i] = -1;
+	for (i = 0; i < nvertices; i++) {
+		if (g->vfixed != NULL && g->vfixed[i] != -1)
+			vertices_moves[i] = nvertices;
+		else
+			vertices_moves[i] = -1;
+	}
 
 	/* Iterations of FM heuristic */
 	for (iter = 0; iter < FM_ITERS_MAX; iter++) {
@@ -226,7 +232,9 @@ int gpart_refine_bisection_fm(csrgraph_t *g, int *bisection, int *partsizes,
 
 		for (i = 0; i < nvertices; i++) {
 			j = perm[i];
-			if (extcosts[j] > 0 || adjindexes[i] == adjindexes[i + 1]) {
+			if (vertices_moves[j] == -1
+			    && (extcosts[j] > 0 || adjindexes[i] == adjindexes[i + 1]))
+			{
 				fm_pqueue_insert(pqueues[bisection[j]], j,
 						         extcosts[j] - intcosts[j]);
 			}
@@ -361,7 +369,7 @@ errhandler:
 }
 
 /*
- * gpart_balance_bisection_fm: Balance bisection.
+ * gpart_balance_bisection_fm: Balance bisection, fixed vertices are not moved.
  */
 int gpart_balance_bisection_fm(csrgraph_t *g, int *bisection, int nmoves,
 		                       int moveto)
@@ -429,8 +437,13 @@ int gpart_balance_bisection_fm(csrgraph_t *g, int *bisection, int nmoves,
 		goto errhandler;
 	}
 
-	for (i = 0; i < g->nvertices; i++)
-		vertices_moves[i] = -1;
+	/* Fixed vertices are locked */
+	for (i = 0; i < g->nvertices; i++) {
+		if (g->vfixed != NULL && g->vfixed[i] != -1)
+			vertices_moves[i] = g->nvertices;
+		else
+			vertices_moves[i] = -1;
+	}
 
 	/* Iterations of FM heuristic */
 	for (iter = 0; iter < 1; iter++) {
@@ -450,7 +463,9 @@ int gpart_balance_bisection_fm(csrgraph_t *g, int *bisection, int nmoves,
 
 		for (i = 0; i < g->nvertices; i++) {
 			j = perm[i];
-			if (extcosts[j] > 0 || g->adjindexes[j] == g->adjindexes[j + 1]) {
+			if (vertices_moves[j] == -1 && (extcosts[j] > 0
+			    || g->adjindexes[j] == g->adjindexes[j + 1]))
+			{
 				fm_pqueue_insert(pqueues[bisection[j]], j,
 						         extcosts[j] - intcosts[j]);
 			}
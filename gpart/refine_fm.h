@@ -22,13 +22,17 @@ extern "C" {
 
 /*
  * gpart_refine_bisection_fm: Refine bisection by Fiduccia-Mattheyses heuristic.
+ *                            Fixed vertices (g->vfixed) are not moved.
  *                            Return edge-cut in edgecut.
  *                            Return 0 on success and 1 otherwise.
  */
 int gpart_refine_bisection_fm(csrgraph_t *g, int *bisection, int *partsizes,
 		                      edgecut_t *edgecut);
 
-/* gpart_balance_bisection_fm: Balance bisection by FM heuristic. */
+/*
+ * gpart_balance_bisection_fm: Balance bisection by FM heuristic.
+ *                             Fixed vertices (g->vfixed) are not moved.
+ */
 int gpart_balance_bisection_fm(csrgraph_t *g, int *bisection, int nmoves,
 		                       int moveto);
 
@@ -0,0 +1,842 @@
+/*
+ * refine_kway.c: k-way refinement of partitions.
+ *
+ * Sizes of parts are fixed (slots of nodes), so vertices are not moved but
+ * swapped. Hop-bytes and link congestion: every boundary vertex selects
+ * part where it gains most by hop-bytes, and vertices selecting part of
+ * each other are swapped while swap improves objective. Maximal external
+ * volume: vertices of busiest part are swapped with best partners of
+ * other parts while external volume of busiest part decreases.
+ * Channels of vertex weights: vertex of most overloaded part is swapped
+ * with vertex of other part which removes overload at least growth of
+ * edge-cut.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpart.h"
+#include "nettopo.h"
+
+#define REFINE_KWAY_PASSES_MAX 16
+
+typedef struct kway_move kway_move_t;
+struct kway_move {
+	int from, to;
+	int v;
+	long long gain;
+};
+
+/* Swap of vertices v and u: return 1 if swap is done */
+typedef int (*kway_swap_t)(void *arg, int v, int u);
+
+typedef struct kway_hopbytes kway_hopbytes_t;
+struct kway_hopbytes {
+	csrgraph_t *g;
+	int *part;
+	const int *partnode;
+	const gpart_nettopo_t *t;
+};
+
+typedef struct kway_minmax kway_minmax_t;
+struct kway_minmax {
+	csrgraph_t *g;
+	int *part;
+	long long *ext;				/* External volume of part */
+	long long *conn;			/* Weight of edges of vertex to part */
+	int *first;					/* Vertices of part p are */
+	int *order;					/* order[first[p] .. first[p + 1] - 1] */
+	int *where;					/* Index of vertex in order */
+	kway_move_t *moves;
+};
+
+typedef struct kway_congestion kway_congestion_t;
+struct kway_congestion {
+	csrgraph_t *g;
+	int *part;
+	const int *partnode;
+	const gpart_nettopo_t *t;
+	long long *loads;
+	long long maxload;
+	int *route;
+	int *links;					/* Links changed by swap */
+	int nlinks;
+	double sqdelta;				/* Change of sum of squares of loads */
+};
+
+typedef struct kway_balance kway_balance_t;
+struct kway_balance {
+	csrgraph_t *g;
+	int *part;
+	int nparts;
+	const int *fixed;
+	long long *loads;			/* Load of part p in channel c is */
+	double *limits;				/* loads[c * nparts + p] */
+	double avg[CSRGRAPH_VCHANNELS_MAX];	/* Mean weight of vertex */
+	long long *conn;			/* Weight of edges of vertex to part */
+	long long *intw;			/* Weight of edges to own part */
+	long long *partw;			/* Weight of edges to balanced part */
+	long long *adjw;			/* Weight of edges to vertex v */
+};
+
+static int kway_refine(csrgraph_t *g, int *part, int nparts,
+                       const int *partnode, const gpart_nettopo_t *t,
+                       int npasses, int positive, kway_swap_t swap,
+                       void *arg);
+static int kway_move_cmp(const void *a, const void *b);
+static int kway_pair_cmp(const void *a, const void *b);
+static int hopbytes_swap(void *arg, int v, int u);
+static long long hopbytes_swap_gain(csrgraph_t *g, const int *part,
+                                    const int *partnode,
+                                    const gpart_nettopo_t *t, int v, int u);
+static int minmax_part(kway_minmax_t *m, int p);
+static int minmax_gain_cmp(const void *a, const void *b);
+static void minmax_swap(kway_minmax_t *m, int v, int u);
+static void minmax_move(kway_minmax_t *m, int v, int to);
+static int congestion_swap(void *arg, int v, int u);
+static void congestion_move(kway_congestion_t *c, int v, int to);
+static void congestion_route(kway_congestion_t *c, int p, int q, long long w);
+static double balance_excess(kway_balance_t *b, int c, int p, long long load);
+static int balance_part(kway_balance_t *b, int p);
+
+#define PARTDIST(p, q) gpart_nettopo_distance(t, partnode[p], partnode[q])
+
+/* gpart_compute_hopbytes: Return sum of weight times distance over edges. */
+edgecut_t gpart_compute_hopbytes(csrgraph_t *g, const int *part,
+                                 const int *partnode,
+                                 const gpart_nettopo_t *t)
+{
+	int i, j;
+	edgecut_t hopbytes = 0;
+
+	for (i = 0; i < g->nvertices; i++) {
+		for (j = g->adjindexes[i]; j < g->adjindexes[i + 1]; j++) {
+			if (part[i] != part[g->adjv[j]]) {
+				hopbytes += (edgecut_t)g->edges[j]
+				            * PARTDIST(part[i], part[g->adjv[j]]);
+			}
+		}
+	}
+	return hopbytes / 2;
+}
+
+/* gpart_compute_linkloads: Compute loads of links, return maximal load. */
+long long gpart_compute_linkloads(csrgraph_t *g, const int *part, int nparts,
+                                  const int *partnode,
+                                  const gpart_nettopo_t *t, long long *loads)
+{
+	gpart_traffic_t *tr;
+	long long maxload = 0;
+	int *route, i, j, k, n;
+
+	if (t->nlinks == 0)
+		return -1;
+	if ( (route = malloc(sizeof(*route) * (t->routemax + 1))) == NULL)
+		return -1;
+	if ( (tr = gpart_traffic_build(g, part, nparts)) == NULL) {
+		free(route);
+		return -1;
+	}
+	memset(loads, 0, sizeof(*loads) * t->nlinks);
+	for (i = 0; i < nparts; i++) {
+		for (j = tr->index[i]; j < tr->index[i + 1]; j++) {
+			n = gpart_nettopo_route(t, partnode[i], partnode[tr->adjp[j]],
+			                        route);
+			for (k = 0; k < n; k++)
+				loads[route[k]] += tr->volume[j];
+		}
+	}
+	for (i = 0; i < t->nlinks; i++) {
+		if (loads[i] > maxload)
+			maxload = loads[i];
+	}
+	gpart_traffic_free(tr);
+	free(route);
+	return maxload;
+}
+
+/* gpart_refine_hopbytes: k-way refinement of hop-bytes by swaps. */
+int gpart_refine_hopbytes(csrgraph_t *g, int *part, int nparts,
+                          const int *partnode, const gpart_nettopo_t *t,
+                          int npasses)
+{
+	kway_hopbytes_t h;
+
+	h.g = g;
+	h.part = part;
+	h.partnode = partnode;
+	h.t = t;
+	return kway_refine(g, part, nparts, partnode, t, npasses, 1,
+	                   hopbytes_swap, &h);
+}
+
+/* gpart_refine_minmax: k-way refinement of maximal external volume. */
+int gpart_refine_minmax(csrgraph_t *g, int *part, int nparts, int npasses)
+{
+	kway_minmax_t m;
+	int i, j, p, iter, rc = 1;
+
+	memset(&m, 0, sizeof(m));
+	m.g = g;
+	m.part = part;
+	m.ext = calloc(nparts, sizeof(*m.ext));
+	m.conn = calloc(nparts, sizeof(*m.conn));
+	m.first = calloc(nparts + 1, sizeof(*m.first));
+	m.order = malloc(sizeof(*m.order) * (g->nvertices + 1));
+	m.where = malloc(sizeof(*m.where) * (g->nvertices + 1));
+	m.moves = malloc(sizeof(*m.moves) * (g->adjindexes[g->nvertices] + 1));
+	if (m.ext == NULL || m.conn == NULL || m.first == NULL
+	    || m.order == NULL || m.where == NULL || m.moves == NULL)
+	{
+		goto errhandler;
+	}
+
+	/* External volumes of parts, vertices are sorted by parts */
+	for (i = 0; i < g->nvertices; i++) {
+		if (part[i] < 0 || part[i] >= nparts)
+			goto errhandler;
+		m.first[part[i] + 1]++;
+		for (j = g->adjindexes[i]; j < g->adjindexes[i + 1]; j++) {
+			if (part[i] != part[g->adjv[j]])
+				m.ext[part[i]] += g->edges[j];
+		}
+	}
+	for (p = 0; p < nparts; p++)
+		m.first[p + 1] += m.first[p];
+	for (i = 0; i < g->nvertices; i++) {
+		m.where[i] = m.first[part[i]]++;
+		m.order[m.where[i]] = i;
+	}
+	for (p = nparts; p > 0; p--)
+		m.first[p] = m.first[p - 1];
+	m.first[0] = 0;
+
+	/* Busiest part is improved while some its vertex can be swapped */
+	if (npasses <= 0)
+		npasses = REFINE_KWAY_PASSES_MAX;
+	for (iter = 0; iter < npasses * g->nvertices; iter++) {
+		for (p = 0, i = 1; i < nparts; i++) {
+			if (m.ext[i] > m.ext[p])
+				p = i;
+		}
+		if (!minmax_part(&m, p))
+			break;
+	}
+	rc = 0;
+
+errhandler:
+	free(m.ext);
+	free(m.conn);
+	free(m.first);
+	free(m.order);
+	free(m.where);
+	free(m.moves);
+	return rc;
+}
+
+/* gpart_refine_congestion: k-way refinement of maximal link load. */
+int gpart_refine_congestion(csrgraph_t *g, int *part, int nparts,
+                            const int *partnode, const gpart_nettopo_t *t,
+                            int npasses)
+{
+	kway_congestion_t c;
+	int i, maxdeg, rc = 1;
+
+	if (t->nlinks == 0)
+		return 1;
+	for (i = 0; i < nparts; i++) {
+		if (partnode[i] < 0 || partnode[i] >= t->nnodes)
+			return 1;
+	}
+	for (i = 0, maxdeg = 0; i < g->nvertices; i++) {
+		if (g->adjindexes[i + 1] - g->adjindexes[i] > maxdeg)
+			maxdeg = g->adjindexes[i + 1] - g->adjindexes[i];
+	}
+	memset(&c, 0, sizeof(c));
+	c.g = g;
+	c.part = part;
+	c.partnode = partnode;
+	c.t = t;
+	c.loads = malloc(sizeof(*c.loads) * t->nlinks);
+	c.route = malloc(sizeof(*c.route) * (t->routemax + 1));
+	/* Swap moves two vertices, every edge changes two routes twice */
+	c.links = malloc(sizeof(*c.links) * (8 * (size_t)maxdeg * t->routemax
+	                                     + 1));
+	if (c.loads == NULL || c.route == NULL || c.links == NULL)
+		goto errhandler;
+	if ( (c.maxload = gpart_compute_linkloads(g, part, nparts, partnode, t,
+	                                           c.loads)) < 0)
+	{
+		goto errhandler;
+	}
+	rc = kway_refine(g, part, nparts, partnode, t, npasses, 0,
+	                 congestion_swap, &c);
+
+errhandler:
+	free(c.loads);
+	free(c.route);
+	free(c.links);
+	return rc;
+}
+
+/* gpart_balance_vchannels: Swaps of vertices of most overloaded part. */
+int gpart_balance_vchannels(csrgraph_t *g, int *part, int nparts,
+                            const int *fixed, double tolerance, int npasses)
+{
+	kway_balance_t b;
+	int *sizes = NULL;
+	long long total;
+	double excess, maxexcess;
+	int c, i, p, maxp, iter, rc = 1;
+
+	if (g->nvchannels == 0)
+		return 0;
+	memset(&b, 0, sizeof(b));
+	b.g = g;
+	b.part = part;
+	b.nparts = nparts;
+	b.fixed = fixed;
+	sizes = calloc(nparts, sizeof(*sizes));
+	b.loads = calloc((size_t)g->nvchannels * nparts, sizeof(*b.loads));
+	b.limits = malloc(sizeof(*b.limits) * g->nvchannels * nparts);
+	b.conn = calloc(nparts, sizeof(*b.conn));
+	b.intw = malloc(sizeof(*b.intw) * (g->nvertices + 1));
+	b.partw = malloc(sizeof(*b.partw) * (g->nvertices + 1));
+	b.adjw = calloc(g->nvertices + 1, sizeof(*b.adjw));
+	if (sizes == NULL || b.loads == NULL || b.limits == NULL
+	    || b.conn == NULL || b.intw == NULL || b.partw == NULL
+	    || b.adjw == NULL)
+	{
+		goto errhandler;
+	}
+
+	/* Share of part in channel is proportional to its size */
+	for (i = 0; i < g->nvertices; i++) {
+		if (part[i] < 0 || part[i] >= nparts)
+			goto errhandler;
+		sizes[part[i]]++;
+		for (c = 0; c < g->nvchannels; c++)
+			b.loads[c * nparts + part[i]] += g->vchannels[c][i];
+	}
+	for (c = 0; c < g->nvchannels; c++) {
+		for (p = 0, total = 0; p < nparts; p++)
+			total += b.loads[c * nparts + p];
+		b.avg[c] = (double)total / g->nvertices;
+		for (p = 0; p < nparts; p++) {
+			b.limits[c * nparts + p] = (1.0 + tolerance) * (double)total
+			                           * sizes[p] / g->nvertices;
+		}
+	}
+
+	if (npasses <= 0)
+		npasses = REFINE_KWAY_PASSES_MAX;
+	for (iter = 0; iter < npasses * g->nvertices; iter++) {
+		for (p = 0, maxp = -1, maxexcess = 0; p < nparts; p++) {
+			for (c = 0, excess = 0; c < g->nvchannels; c++)
+				excess += balance_excess(&b, c, p, b.loads[c * nparts + p]);
+			if (excess > maxexcess) {
+				maxexcess = excess;
+				maxp = p;
+			}
+		}
+		if (maxp < 0 || !balance_part(&b, maxp))
+			break;
+	}
+	rc = 0;
+
+errhandler:
+	free(sizes);
+	free(b.loads);
+	free(b.limits);
+	free(b.conn);
+	free(b.intw);
+	free(b.partw);
+	free(b.adjw);
+	return rc;
+}
+
+/* gpart_compute_imbalance: Return maximal ratio of load to share. */
+double gpart_compute_imbalance(csrgraph_t *g, const int *part, int nparts,
+                               int channel)
+{
+	long long *loads, total = 0;
+	int *sizes, i, p;
+	double ratio, maxratio = 0;
+
+	if (channel < 0 || channel >= g->nvchannels)
+		return -1.0;
+	loads = calloc(nparts, sizeof(*loads));
+	sizes = calloc(nparts, sizeof(*sizes));
+	if (loads == NULL || sizes == NULL) {
+		free(loads);
+		free(sizes);
+		return -1.0;
+	}
+	for (i = 0; i < g->nvertices; i++) {
+		loads[part[i]] += g->vchannels[channel][i];
+		sizes[part[i]]++;
+		total += g->vchannels[channel][i];
+	}
+	for (p = 0; p < nparts; p++) {
+		if (sizes[p] == 0 || total == 0)
+			continue;
+		ratio = (double)loads[p] * g->nvertices / ((double)total * sizes[p]);
+		if (ratio > maxratio)
+			maxratio = ratio;
+	}
+	free(loads);
+	free(sizes);
+	return total > 0 ? maxratio : 1.0;
+}
+
+/*
+ * kway_refine: Pass over boundary vertices: every vertex selects part with
+ *              best hop-bytes gain, then vertices of opposite moves
+ *              p -> q and q -> p are swapped by function swap until it
+ *              fails. Moves without positive gain are skipped if positive
+ *              is set.
+ */
+static int kway_refine(csrgraph_t *g, int *part, int nparts,
+                       const int *partnode, const gpart_nettopo_t *t,
+                       int npasses, int positive, kway_swap_t swap,
+                       void *arg)
+{
+	kway_move_t *moves = NULL, key, *b;
+	long long *conn = NULL, base, cost, gain, bestgain;
+	int *touched = NULL;
+	int i, j, k, r, v, p, q, ntouched, nmoves, bestq, nswaps, pass;
+	int err = 0, na, nb;
+
+	for (i = 0; i < nparts; i++) {
+		if (partnode[i] < 0 || partnode[i] >= t->nnodes)
+			return 1;
+	}
+	moves = malloc(sizeof(*moves) * (g->nvertices + 1));
+	conn = calloc(nparts, sizeof(*conn));
+	touched = malloc(sizeof(*touched) * (nparts + 1));
+	if (moves == NULL || conn == NULL || touched == NULL) {
+		err = 1;
+		goto errhandler;
+	}
+	if (npasses <= 0)
+		npasses = REFINE_KWAY_PASSES_MAX;
+
+	for (pass = 0; pass < npasses; pass++) {
+
+		/* Best target part of every boundary vertex */
+		for (v = 0, nmoves = 0; v < g->nvertices; v++) {
+			p = part[v];
+			for (j = g->adjindexes[v], ntouched = 0;
+			     j < g->adjindexes[v + 1]; j++)
+			{
+				r = part[g->adjv[j]];
+				if (conn[r] == 0)
+					touched[ntouched++] = r;
+				conn[r] += g->edges[j];
+			}
+			for (k = 0, base = 0; k < ntouched; k++)
+				base += conn[touched[k]] * PARTDIST(p, touched[k]);
+
+			bestq = -1;
+			bestgain = 0;
+			for (i = 0; i < ntouched; i++) {
+				if ( (q = touched[i]) == p)
+					continue;
+				for (k = 0, cost = 0; k < ntouched; k++)
+					cost += conn[touched[k]] * PARTDIST(q, touched[k]);
+				gain = base - cost;
+				if (bestq < 0 || gain > bestgain) {
+					bestq = q;
+					bestgain = gain;
+				}
+			}
+			for (k = 0; k < ntouched; k++)
+				conn[touched[k]] = 0;
+
+			if (bestq >= 0) {
+				moves[nmoves].from = p;
+				moves[nmoves].to = bestq;
+				moves[nmoves].v = v;
+				moves[nmoves].gain = bestgain;
+				nmoves++;
+			}
+		}
+		qsort(moves, nmoves, sizeof(*moves), kway_move_cmp);
+
+		/* Swap vertices of opposite moves p -> q and q -> p */
+		for (i = 0, nswaps = 0; i < nmoves; i += na) {
+			p = moves[i].from;
+			q = moves[i].to;
+			for (na = 1; i + na < nmoves && moves[i + na].from == p
+			             && moves[i + na].to == q; na++)
+				;
+			if (positive && moves[i].gain <= 0)
+				continue;
+
+			key.from = q;
+			key.to = p;
+			b = bsearch(&key, moves, nmoves, sizeof(*moves), kway_pair_cmp);
+			if (b == NULL)
+				continue;
+			while (b > moves && (b - 1)->from == q && (b - 1)->to == p)
+				b--;
+			for (nb = 0; b + nb < moves + nmoves && b[nb].from == q
+			             && b[nb].to == p; nb++)
+				;
+
+			for (k = 0; k < na && k < nb; k++) {
+				v = moves[i + k].v;
+				j = b[k].v;
+				if (part[v] != p || part[j] != q)
+					break;
+				if (!swap(arg, v, j))
+					break;
+				nswaps++;
+			}
+		}
+		if (nswaps == 0)
+			break;
+	}
+
+errhandler:
+	free(moves);
+	free(conn);
+	free(touched);
+	return err;
+}
+
+/* kway_pair_cmp: Order moves by source and target parts. */
+static int kway_pair_cmp(const void *a, const void *b)
+{
+	const kway_move_t *x = a, *y = b;
+
+	if (x->from != y->from)
+		return x->from < y->from ? -1 : 1;
+	if (x->to != y->to)
+		return x->to < y->to ? -1 : 1;
+	return 0;
+}
+
+/*
+ * kway_move_cmp: Order moves by source part, target part and gain
+ *                (descending).
+ */
+static int kway_move_cmp(const void *a, const void *b)
+{
+	const kway_move_t *x = a, *y = b;
+	int rc;
+
+	if ( (rc = kway_pair_cmp(a, b)) != 0)
+		return rc;
+	if (x->gain != y->gain)
+		return x->gain > y->gain ? -1 : 1;
+	return x->v - y->v;
+}
+
+/* hopbytes_swap: Swap v and u if hop-bytes decrease. */
+static int hopbytes_swap(void *arg, int v, int u)
+{
+	kway_hopbytes_t *h = arg;
+	int p;
+
+	if (hopbytes_swap_gain(h->g, h->part, h->partnode, h->t, v, u) <= 0)
+		return 0;
+	p = h->part[v];
+	h->part[v] = h->part[u];
+	h->part[u] = p;
+	return 1;
+}
+
+/*
+ * hopbytes_swap_gain: Return decrease of hop-bytes if v and u exchange
+ *                     parts. Edge (v, u) keeps its length.
+ */
+static long long hopbytes_swap_gain(csrgraph_t *g, const int *part,
+                                    const int *partnode,
+                                    const gpart_nettopo_t *t, int v, int u)
+{
+	long long gain = 0;
+	int j, x, pv = part[v], pu = part[u];
+
+	for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+		if ( (x = g->adjv[j]) != u) {
+			gain += (long long)g->edges[j]
+			        * (PARTDIST(pv, part[x]) - PARTDIST(pu, part[x]));
+		}
+	}
+	for (j = g->adjindexes[u]; j < g->adjindexes[u + 1]; j++) {
+		if ( (x = g->adjv[j]) != v) {
+			gain += (long long)g->edges[j]
+			        * (PARTDIST(pu, part[x]) - PARTDIST(pv, part[x]));
+		}
+	}
+	return gain;
+}
+
+/*
+ * minmax_part: Swap vertex of part p with vertex of other part if maximal
+ *              external volume of two parts decreases (or does not change
+ *              and their sum decreases). Moves of vertices to adjacent
+ *              parts are tried in order of decrease of external volume of
+ *              p by leaving of vertex; partner of vertex in target part
+ *              gives best result. Return 1 if swap is done.
+ */
+static int minmax_part(kway_minmax_t *m, int p)
+{
+	csrgraph_t *g = m->g;
+	long long before, sum, after, aftersum, best, bestsum, degw, gain;
+	int i, j, k, r, q, u, v, bestu, nmoves = 0;
+
+	for (i = m->first[p]; i < m->first[p + 1]; i++) {
+		v = m->order[i];
+		for (j = g->adjindexes[v], degw = 0; j < g->adjindexes[v + 1]; j++) {
+			m->conn[m->part[g->adjv[j]]] += g->edges[j];
+			degw += g->edges[j];
+		}
+		/* Every adjacent part is target once (conn is cleared) */
+		gain = degw - 2 * m->conn[p];
+		for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+			r = m->part[g->adjv[j]];
+			if (r != p && m->conn[r] > 0) {
+				m->moves[nmoves].from = p;
+				m->moves[nmoves].to = r;
+				m->moves[nmoves].v = v;
+				m->moves[nmoves].gain = gain;
+				nmoves++;
+			}
+			m->conn[r] = 0;
+		}
+		m->conn[p] = 0;
+	}
+	qsort(m->moves, nmoves, sizeof(*m->moves), minmax_gain_cmp);
+
+	for (k = 0; k < nmoves; k++) {
+		v = m->moves[k].v;
+		q = m->moves[k].to;
+		before = m->ext[p] > m->ext[q] ? m->ext[p] : m->ext[q];
+		sum = m->ext[p] + m->ext[q];
+		best = before;
+		bestsum = sum;
+		bestu = -1;
+		for (i = m->first[q]; i < m->first[q + 1]; i++) {
+			u = m->order[i];
+			minmax_move(m, v, q);
+			minmax_move(m, u, p);
+			after = m->ext[p] > m->ext[q] ? m->ext[p] : m->ext[q];
+			aftersum = m->ext[p] + m->ext[q];
+			minmax_move(m, u, q);
+			minmax_move(m, v, p);
+			if (after < best || (after == best && aftersum < bestsum)) {
+				best = after;
+				bestsum = aftersum;
+				bestu = u;
+			}
+		}
+		if (bestu >= 0) {
+			minmax_swap(m, v, bestu);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* minmax_gain_cmp: Order moves by gain (descending). */
+static int minmax_gain_cmp(const void *a, const void *b)
+{
+	const kway_move_t *x = a, *y = b;
+
+	if (x->gain != y->gain)
+		return x->gain > y->gain ? -1 : 1;
+	if (x->v != y->v)
+		return x->v - y->v;
+	return x->to - y->to;
+}
+
+/* minmax_swap: Swap v and u between parts and their positions in order. */
+static void minmax_swap(kway_minmax_t *m, int v, int u)
+{
+	int i, p = m->part[v], q = m->part[u];
+
+	minmax_move(m, v, q);
+	minmax_move(m, u, p);
+	i = m->where[v];
+	m->where[v] = m->where[u];
+	m->where[u] = i;
+	m->order[m->where[v]] = v;
+	m->order[m->where[u]] = u;
+}
+
+/*
+ * minmax_move: Move v to part to. Only external volumes of source and
+ *              target parts change: cut edges of v leave source part,
+ *              internal edges of v become external for it; edges of v to
+ *              target part become internal.
+ */
+static void minmax_move(kway_minmax_t *m, int v, int to)
+{
+	csrgraph_t *g = m->g;
+	long long degw = 0;
+	int j, from = m->part[v];
+
+	for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+		m->conn[m->part[g->adjv[j]]] += g->edges[j];
+		degw += g->edges[j];
+	}
+	m->ext[from] += 2 * m->conn[from] - degw;
+	m->ext[to] += degw - 2 * m->conn[to];
+	for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++)
+		m->conn[m->part[g->adjv[j]]] = 0;
+	m->part[v] = to;
+}
+
+/*
+ * congestion_swap: Swap v and u if no changed link gets load above maximal
+ *                  load and sum of squares of loads decreases; otherwise
+ *                  swap is undone.
+ */
+static int congestion_swap(void *arg, int v, int u)
+{
+	kway_congestion_t *c = arg;
+	int i, p = c->part[v], q = c->part[u];
+
+	c->nlinks = 0;
+	c->sqdelta = 0;
+	congestion_move(c, v, q);
+	congestion_move(c, u, p);
+	if (c->sqdelta < 0) {
+		for (i = 0; i < c->nlinks; i++) {
+			if (c->loads[c->links[i]] > c->maxload)
+				break;
+		}
+		if (i == c->nlinks)
+			return 1;
+	}
+	congestion_move(c, u, q);
+	congestion_move(c, v, p);
+	return 0;
+}
+
+/* congestion_move: Move v to part to and update loads of links. */
+static void congestion_move(kway_congestion_t *c, int v, int to)
+{
+	csrgraph_t *g = c->g;
+	int j, px, from = c->part[v];
+
+	for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+		px = c->part[g->adjv[j]];
+		congestion_route(c, from, px, -g->edges[j]);
+		congestion_route(c, px, from, -g->edges[j]);
+	}
+	c->part[v] = to;
+	for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+		px = c->part[g->adjv[j]];
+		congestion_route(c, to, px, g->edges[j]);
+		congestion_route(c, px, to, g->edges[j]);
+	}
+}
+
+/* congestion_route: Add w to loads of links of route from part p to q. */
+static void congestion_route(kway_congestion_t *c, int p, int q, long long w)
+{
+	long long *load;
+	int k, n;
+
+	if (p == q)
+		return;
+	n = gpart_nettopo_route(c->t, c->partnode[p], c->partnode[q], c->route);
+	for (k = 0; k < n; k++) {
+		load = &c->loads[c->route[k]];
+		c->sqdelta += (double)w * (2.0 * (double)*load + (double)w);
+		*load += w;
+		if (w > 0)
+			c->links[c->nlinks++] = c->route[k];
+	}
+}
+
+/*
+ * balance_excess: Return overload of part p with load in channel c in
+ *                 units of mean weight of vertex.
+ */
+static double balance_excess(kway_balance_t *b, int c, int p, long long load)
+{
+	double excess = (double)load - b->limits[c * b->nparts + p];
+
+	return (excess > 0 && b->avg[c] > 0) ? excess / b->avg[c] : 0;
+}
+
+/*
+ * balance_part: Swap vertex v of overloaded part p with vertex u of other
+ *               part q: sum of overloads of p and q has to decrease, swap
+ *               with minimal growth of edge-cut per unit of removed
+ *               overload is taken. Return 1 if swap is done.
+ */
+static int balance_part(kway_balance_t *b, int p)
+{
+	csrgraph_t *g = b->g;
+	int *part = b->part, nparts = b->nparts;
+	long long lp, lq, dcut;
+	double dexcess, ratio, bestratio = 0;
+	int c, j, q, u, v, bestv = -1, bestu = -1;
+
+	for (u = 0; u < g->nvertices; u++) {
+		b->intw[u] = 0;
+		b->partw[u] = 0;
+		for (j = g->adjindexes[u]; j < g->adjindexes[u + 1]; j++) {
+			if (part[g->adjv[j]] == part[u])
+				b->intw[u] += g->edges[j];
+			if (part[g->adjv[j]] == p)
+				b->partw[u] += g->edges[j];
+		}
+	}
+
+	for (v = 0; v < g->nvertices; v++) {
+		if (part[v] != p || (b->fixed && b->fixed[v] >= 0))
+			continue;
+		for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+			b->conn[part[g->adjv[j]]] += g->edges[j];
+			b->adjw[g->adjv[j]] += g->edges[j];
+		}
+		for (u = 0; u < g->nvertices; u++) {
+			if ( (q = part[u]) == p || (b->fixed && b->fixed[u] >= 0))
+				continue;
+			for (c = 0, dexcess = 0; c < g->nvchannels; c++) {
+				lp = b->loads[c * nparts + p];
+				lq = b->loads[c * nparts + q];
+				dexcess += balance_excess(b, c, p, lp - g->vchannels[c][v]
+				                                   + g->vchannels[c][u])
+				           + balance_excess(b, c, q, lq - g->vchannels[c][u]
+				                                     + g->vchannels[c][v])
+				           - balance_excess(b, c, p, lp)
+				           - balance_excess(b, c, q, lq);
+			}
+			if (dexcess > -1e-9)
+				continue;
+			dcut = b->intw[v] + b->intw[u] - b->conn[q] - b->partw[u]
+			       + 2 * b->adjw[u];
+			ratio = (double)dcut / -dexcess;
+			if (bestv < 0 || ratio < bestratio) {
+				bestratio = ratio;
+				bestv = v;
+				bestu = u;
+			}
+		}
+		for (j = g->adjindexes[v]; j < g->adjindexes[v + 1]; j++) {
+			b->conn[part[g->adjv[j]]] = 0;
+			b->adjw[g->adjv[j]] = 0;
+		}
+	}
+	if (bestv < 0)
+		return 0;
+
+	q = part[bestu];
+	for (c = 0; c < g->nvchannels; c++) {
+		b->loads[c * nparts + p] += g->vchannels[c][bestu]
+		                            - g->vchannels[c][bestv];
+		b->loads[c * nparts + q] += g->vchannels[c][bestv]
+		                            - g->vchannels[c][bestu];
+	}
+	part[bestv] = q;
+	part[bestu] = p;
+	return 1;
+}
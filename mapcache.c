@@ -0,0 +1,174 @@
+/*
+ * mapcache.c: Cache of mappings.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include "mapcache.h"
+
+#define MAPCACHE_PATH_MAX 4096
+
+/* FNV-1a, 64 bit */
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME  1099511628211ULL
+
+static uint64_t fnv_update(uint64_t h, const void *data, size_t size)
+{
+    const unsigned char *p = data;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+
+    return h;
+}
+
+static uint64_t fnv_string(uint64_t h, const char *s)
+{
+    if (s == NULL) {
+        s = "";
+    }
+    /* Terminating zero separates strings */
+    return fnv_update(h, s, strlen(s) + 1);
+}
+
+static uint64_t fnv_file(uint64_t h, const char *filename)
+{
+    unsigned char buf[65536];
+    FILE *f;
+    size_t n;
+
+    if ((f = fopen(filename, "rb")) == NULL) {
+        return fnv_string(h, filename);
+    }
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        h = fnv_update(h, buf, n);
+    }
+    fclose(f);
+
+    return h;
+}
+
+/* Sidecar is optional, its absence must not collide with an empty file */
+static uint64_t fnv_sidecar(uint64_t h, const char *graph, const char *suffix)
+{
+    char path[MAPCACHE_PATH_MAX];
+    unsigned char buf[65536];
+    FILE *f;
+    size_t n;
+
+    snprintf(path, sizeof(path), "%s%s", graph, suffix);
+    if ((f = fopen(path, "rb")) == NULL) {
+        return h;
+    }
+    h = fnv_string(h, suffix);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        h = fnv_update(h, buf, n);
+    }
+    fclose(f);
+
+    return h;
+}
+
+static void mapcache_path(char *path, const char *dir, uint64_t key)
+{
+    snprintf(path, MAPCACHE_PATH_MAX, "%s/mpipgo-%016" PRIx64 ".map", dir,
+             key);
+}
+
+uint64_t mapcache_key(const char *graph, int *pweights, int nparts,
+                      int *gweights, int ngroups, const char *algo,
+                      const char *extrapolate, const char *topo,
+                      const char *pins, const char *balance, int commsize)
+{
+    uint64_t h = FNV_OFFSET;
+
+    h = fnv_string(h, algo);
+    h = fnv_string(h, extrapolate);
+    h = fnv_string(h, topo);
+    if (pins != NULL) {
+        h = fnv_string(h, pins);
+    }
+    if (balance != NULL) {
+        h = fnv_string(h, balance);
+    }
+    h = fnv_update(h, &commsize, sizeof(commsize));
+    h = fnv_update(h, &nparts, sizeof(nparts));
+    h = fnv_update(h, pweights, sizeof(*pweights) * nparts);
+    if (gweights != NULL) {
+        h = fnv_update(h, &ngroups, sizeof(ngroups));
+        h = fnv_update(h, gweights, sizeof(*gweights) * ngroups);
+    }
+    if (graph != NULL) {
+        h = fnv_file(h, graph);
+        /* Vertex weights of the profile are stored next to the graph */
+        h = fnv_sidecar(h, graph, ".vw");
+    }
+
+    return h;
+}
+
+int mapcache_load(const char *dir, uint64_t key, int *part, int commsize,
+                  int *pweights, int nparts)
+{
+    char path[MAPCACHE_PATH_MAX];
+    FILE *f;
+    int *count, i, n, rc = 1;
+
+    mapcache_path(path, dir, key);
+    if ((f = fopen(path, "r")) == NULL) {
+        return 1;
+    }
+    if ((count = calloc(nparts, sizeof(*count))) == NULL) {
+        fclose(f);
+        return 1;
+    }
+    if (fscanf(f, "%d", &n) != 1 || n != commsize) {
+        goto out;
+    }
+    for (i = 0; i < commsize; i++) {
+        if (fscanf(f, "%d", &part[i]) != 1 || part[i] < 0
+            || part[i] >= nparts) {
+            goto out;
+        }
+        count[part[i]]++;
+    }
+    /* Stale or foreign file is a miss */
+    for (i = 0; i < nparts; i++) {
+        if (count[i] != pweights[i]) {
+            goto out;
+        }
+    }
+    rc = 0;
+out:
+    free(count);
+    fclose(f);
+
+    return rc;
+}
+
+int mapcache_save(const char *dir, uint64_t key, int *part, int commsize)
+{
+    char path[MAPCACHE_PATH_MAX], tmp[MAPCACHE_PATH_MAX + 16];
+    FILE *f;
+    int i;
+
+    mapcache_path(path, dir, key);
+    /* Concurrent jobs must not read partially written file */
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+    if ((f = fopen(tmp, "w")) == NULL) {
+        return -1;
+    }
+    fprintf(f, "%d\n", commsize);
+    for (i = 0; i < commsize; i++) {
+        fprintf(f, "%d\n", part[i]);
+    }
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * mapcache.h: Cache of mappings.
+ *
+ * Partition of task graph (part of every process) is stored in directory
+ * MPIPGO_CACHE in file mpipgo-<key>.map. Key is hash of graph file
+ * content (with its <graph>.vw vertex weights, if any), slot counts of nodes (pweights) and of groups of second level,
+ * algorithm and its options, so
+ * repeated runs of the same profile on the same shape of nodes skip loading
+ * and partitioning of graph.
+ */
+#ifndef MAPCACHE_H
+#define MAPCACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+/*
+ * mapcache_key: Function returns key of partition of graph file for nparts
+ * nodes with pweights slots and ngroups groups of second level with
+ * gweights slots. Graph, gweights, network topology, pins and balance
+ * tolerance may be NULL.
+ */
+uint64_t mapcache_key(const char *graph, int *pweights, int nparts,
+                      int *gweights, int ngroups, const char *algo,
+                      const char *extrapolate, const char *topo,
+                      const char *pins, const char *balance, int commsize);
+
+/*
+ * mapcache_load: Function reads partition of commsize processes by key and
+ * checks it against pweights. Returns 0 on hit and 1 on miss.
+ */
+int mapcache_load(const char *dir, uint64_t key, int *part, int commsize,
+                  int *pweights, int nparts);
+
+/* mapcache_save: Function stores partition. Returns 0 on success. */
+int mapcache_save(const char *dir, uint64_t key, int *part, int commsize);
+
+#endif /*MAPCACHE_H*/
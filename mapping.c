@@ -9,28 +9,137 @@
 
 #include "mapping.h"
 
+int *old_mapp, *new_mapp;
+int *subset_nodes, *pweights;
+int npart;
+
+nodes_t *subsystem;
+
+/*
+ * Groups of second level: processes of node part sharing domain (socket,
+ * NUMA node or L3 cache, see topology.h). Groups of node part p are
+ * gfirst[p] .. gfirst[p + 1] - 1.
+ */
+static int *old_domain = NULL, *old_group, *new_group, *gweights, *gfirst;
+static int *gident;
+static int ngroups = 0;
+
+/* hostname_hash: FNV-1a hash of name of node. */
+static unsigned int hostname_hash()
+{
+    char name[MPI_MAX_PROCESSOR_NAME];
+    unsigned int h = 2166136261u;
+    int i, len;
+
+    if (PMPI_Get_processor_name(name, &len) != MPI_SUCCESS) {
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+
+    return h;
+}
+
+/*
+ * getnodeid: Collective over MPI_COMM_WORLD. Processes sharing memory are
+ * grouped by MPI_Comm_split_type; groups with different hostnames are
+ * separated by hash of hostname. Nodes are numbered 0, 1, ... in order of
+ * their lowest rank.
+ */
 int getnodeid()
 {
-    int nodeid, i;
-    char node[50], c;
-    gethostname(node, sizeof(char) * LENGTH_HOSTNAME);   
-    /* @mk: магические константы (50) использовать нельзя, лучше создать enum */
-    
-    for (i = 4; c <= '9' && c >=0; i++) { /* @mk: здесь неявное предположени, что код 
-                                           символа '8' < кода символа '9'. 
-                                           Так лучше не делать.*/
-        c = node[i];
-        if (c <= '9' && c >=0) {
-            nodeid = nodeid * (i-4) + atoi(&c);
-        } else {
-            break;
-        }
-        
+    MPI_Comm nodecomm, tmpcomm, leaders;
+    int rank, noderank, hash, hashmin, hashmax, nodeid = 0;
+
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    hash = (int)(hostname_hash() & INT_MAX);
+
+#if MPI_VERSION >= 3
+    PMPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                         MPI_INFO_NULL, &nodecomm);
+#else
+    PMPI_Comm_dup(MPI_COMM_WORLD, &nodecomm);
+#endif
+    PMPI_Allreduce(&hash, &hashmin, 1, MPI_INT, MPI_MIN, nodecomm);
+    PMPI_Allreduce(&hash, &hashmax, 1, MPI_INT, MPI_MAX, nodecomm);
+    if (hashmin != hashmax) {
+        PMPI_Comm_split(nodecomm, hash, rank, &tmpcomm);
+        PMPI_Comm_free(&nodecomm);
+        nodecomm = tmpcomm;
     }
-    
+
+    /* Node leaders are numbered by split of MPI_COMM_WORLD */
+    PMPI_Comm_rank(nodecomm, &noderank);
+    PMPI_Comm_split(MPI_COMM_WORLD, (noderank == 0) ? 0 : MPI_UNDEFINED,
+                    rank, &leaders);
+    if (leaders != MPI_COMM_NULL) {
+        PMPI_Comm_rank(leaders, &nodeid);
+        PMPI_Comm_free(&leaders);
+    }
+    PMPI_Bcast(&nodeid, 1, MPI_INT, 0, nodecomm);
+    PMPI_Comm_free(&nodecomm);
+
     return nodeid;
 }
 
+static int mapping_slot_cmp(const void *a, const void *b)
+{
+    const int *x = a, *y = b;
+
+    if (x[0] != y[0]) {
+        return x[0] - y[0];
+    }
+    if (x[1] != y[1]) {
+        return (x[1] < y[1]) ? -1 : 1;
+    }
+    return x[2] - y[2];
+}
+
+/* mapping_initialize_groups: Function groups processes of nodes by domain. */
+static int mapping_initialize_groups(int commsize)
+{
+    int *slots, i;
+
+    slots = malloc(sizeof(int) * 3 * commsize);
+    old_group = malloc(sizeof(int) * commsize);
+    new_group = malloc(sizeof(int) * commsize);
+    gweights = malloc(sizeof(int) * commsize);
+    gident = malloc(sizeof(int) * commsize);
+    gfirst = malloc(sizeof(int) * (npart + 1));
+    if (slots == NULL || old_group == NULL || new_group == NULL
+        || gweights == NULL || gident == NULL || gfirst == NULL) {
+        free(slots);
+        return -1;
+    }
+
+    /* Slots are sorted by node part, domain and rank */
+    for (i = 0; i < commsize; i++) {
+        slots[3 * i] = subset_nodes[old_mapp[i]];
+        slots[3 * i + 1] = old_domain[i];
+        slots[3 * i + 2] = i;
+    }
+    qsort(slots, commsize, sizeof(int) * 3, mapping_slot_cmp);
+
+    for (i = 0, ngroups = 0; i < commsize; i++) {
+        if (i == 0 || slots[3 * i] != slots[3 * (i - 1)]
+            || slots[3 * i + 1] != slots[3 * (i - 1) + 1]) {
+            if (i == 0 || slots[3 * i] != slots[3 * (i - 1)]) {
+                gfirst[slots[3 * i]] = ngroups;
+            }
+            gweights[ngroups] = 0;
+            gident[ngroups] = ngroups;
+            ngroups++;
+        }
+        old_group[slots[3 * i + 2]] = ngroups - 1;
+        gweights[ngroups - 1]++;
+    }
+    gfirst[npart] = ngroups;
+    free(slots);
+
+    return 0;
+}
+
 int mapping_initialize(int commsize)
 {
     int i = 0, j, max;
@@ -66,17 +175,261 @@ int mapping_initialize(int commsize)
             j++;
         }
     }
+    if (old_domain != NULL) {
+        return mapping_initialize_groups(commsize);
+    }
     
     return 0;
 }
-int maping_allocate(int commsize, char *g, int *ranks, char *mpipgo_algo)
+/*
+ * mapping_gpart: Function partitions graph by gpart. Hierarchy of coarse
+ * graphs is read from MPIPGO_HIERARCHY; missing or stale file is rebuilt.
+ */
+static int mapping_gpart(csrgraph_t *graph, char *mpipgo_hierarchy)
+{
+    gpart_hierarchy_t *h;
+    int rc;
+
+    if (mpipgo_hierarchy == NULL) {
+        return gpart_partition_recursive(graph, pweights, npart, new_mapp);
+    }
+    if ((h = gpart_hierarchy_load(graph, mpipgo_hierarchy)) == NULL) {
+        if ((h = gpart_hierarchy_build(graph)) == NULL) {
+            return 1;
+        }
+        if (gpart_hierarchy_save(h, mpipgo_hierarchy) != 0) {
+            fprintf(stderr, "MPIPGO_HIERARCHY: can not save %s\n",
+                    mpipgo_hierarchy);
+        }
+    }
+    rc = gpart_partition_recursive_hierarchy(graph, h, pweights, npart,
+                                             new_mapp);
+    gpart_hierarchy_free(h);
+
+    return rc;
+}
+
+/*
+ * mapping_profile: Function checks that algorithm partitions profile graph
+ * (MPIPGO_GRAPH).
+ */
+static int mapping_profile(char *mpipgo_algo)
+{
+    return strcmp(mpipgo_algo, "gpart") == 0
+           || strcmp(mpipgo_algo, "gpart_minmax") == 0
+           || strcmp(mpipgo_algo, "hopbytes") == 0
+           || strcmp(mpipgo_algo, "congestion") == 0;
+}
+
+/*
+ * mapping_nettopo: Function places parts on nodes of network topology
+ * MPIPGO_TOPO (node p of job is node p of topology) and renumbers parts by
+ * their nodes. Partition is refined by hop-bytes for hopbytes and then by
+ * maximal link load for congestion.
+ */
+static int mapping_nettopo(csrgraph_t *graph, int commsize, char *mpipgo_topo,
+                           char *mpipgo_algo)
+{
+    gpart_nettopo_t *t;
+    int *partnode, i, rc;
+
+    if ((t = gpart_nettopo_parse(mpipgo_topo)) == NULL) {
+        fprintf(stderr, "MPIPGO_TOPO: bad topology %s\n", mpipgo_topo);
+        return -1;
+    }
+    if (t->nnodes < npart) {
+        fprintf(stderr, "MPIPGO_TOPO: %d nodes in topology, but job has %d\n",
+                t->nnodes, npart);
+        gpart_nettopo_free(t);
+        return -1;
+    }
+    if (strcmp(mpipgo_algo, "congestion") == 0 && t->nlinks == 0) {
+        fprintf(stderr, "MPIPGO_TOPO: %s has no routing\n", mpipgo_topo);
+        gpart_nettopo_free(t);
+        return -1;
+    }
+    if ((partnode = malloc(sizeof(*partnode) * npart)) == NULL) {
+        gpart_nettopo_free(t);
+        return -1;
+    }
+    rc = gpart_assign_nodes(graph, new_mapp, npart, pweights, t, partnode);
+    if (rc == 0) {
+        for (i = 0; i < commsize; i++) {
+            new_mapp[i] = partnode[new_mapp[i]];
+        }
+        for (i = 0; i < npart; i++) {
+            partnode[i] = i;
+        }
+        if (strcmp(mpipgo_algo, "hopbytes") == 0
+            || strcmp(mpipgo_algo, "congestion") == 0) {
+            rc = gpart_refine_hopbytes(graph, new_mapp, npart, partnode, t,
+                                       0);
+        }
+        if (rc == 0 && strcmp(mpipgo_algo, "congestion") == 0) {
+            rc = gpart_refine_congestion(graph, new_mapp, npart, partnode, t,
+                                         0);
+        }
+    }
+    free(partnode);
+    gpart_nettopo_free(t);
+
+    return rc > 0 ? -1 : 0;
+}
+
+/*
+ * mapping_pins: Function parses MPIPGO_PINS "rank:node,rank:node,..." and
+ * returns node part of every process or -1. Nodes are numbered as parts
+ * (in order of their lowest rank).
+ */
+static int *mapping_pins(char *mpipgo_pins, int commsize)
 {
-    int i = 0;
-    csrgraph_t *graph;
+    int *fixed, i, rank, node;
+    char *p, *pin, *end;
+
+    if ((fixed = malloc(sizeof(int) * commsize)) == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < commsize; i++) {
+        fixed[i] = -1;
+    }
+    for (p = mpipgo_pins; *p != '\0'; p = (*end == ',') ? end + 1 : end) {
+        rank = (int)strtol(p, &pin, 10);
+        if (pin == p || *pin != ':') {
+            break;
+        }
+        node = (int)strtol(pin + 1, &end, 10);
+        if (end == pin + 1 || (*end != ',' && *end != '\0')
+            || rank < 0 || rank >= commsize || node < 0 || node >= npart
+            || (fixed[rank] != -1 && fixed[rank] != node)) {
+            break;
+        }
+        fixed[rank] = node;
+    }
+    if (*p != '\0') {
+        fprintf(stderr, "MPIPGO_PINS: bad pin %s\n", p);
+        free(fixed);
+        return NULL;
+    }
+
+    return fixed;
+}
+
+/*
+ * mapping_level2: Function partitions vertices of every node part between
+ * groups of node. Vertices fill groups in order if there is no graph.
+ */
+static int mapping_level2(csrgraph_t *graph, int commsize)
+{
+    csrgraph_t *sub = NULL;
+    int p, i, k, n, rc;
+
+    for (p = 0; p < npart; p++) {
+        if (graph != NULL && gfirst[p + 1] - gfirst[p] > 1) {
+            if ((sub = csrgraph_subgraph(graph, new_mapp, p)) == NULL) {
+                return -1;
+            }
+        }
+        /* Subgraphs without edges are filled in order by gpart */
+        if (sub != NULL) {
+            rc = gpart_partition_recursive(sub, &gweights[gfirst[p]],
+                                           gfirst[p + 1] - gfirst[p],
+                                           new_group);
+            for (i = 0; i < commsize; i++) {
+                if (new_mapp[i] == p) {
+                    new_group[i] += gfirst[p];
+                }
+            }
+        } else {
+            for (i = 0, k = gfirst[p], n = 0, rc = 0; i < commsize; i++) {
+                if (new_mapp[i] != p) {
+                    continue;
+                }
+                if (n == gweights[k]) {
+                    k++;
+                    n = 0;
+                }
+                new_group[i] = k;
+                n++;
+            }
+        }
+        if (sub != NULL) {
+            csrgraph_free(sub);
+            free(sub);
+            sub = NULL;
+        }
+        if (rc > 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* mapping_partition: Function computes part of every process in new_mapp. */
+static int mapping_partition(int commsize, char *g, char *mpipgo_algo,
+                             char *mpipgo_extrapolate, char *mpipgo_hierarchy,
+                             char *mpipgo_topo, char *mpipgo_pins,
+                             char *mpipgo_balance)
+{
+    csrgraph_t *graph = NULL;
+    gpart_pattern_t pattern;
+    int *fixed = NULL, rc;
+    double tolerance = 0;
+    char *end;
     
-    graph = csrgraph_load(g);
-    if (graph == NULL) {
-        fprintf(stderr, "gpart load error\n");
+    if (mpipgo_balance != NULL) {
+        tolerance = strtod(mpipgo_balance, &end);
+        if (end == mpipgo_balance || *end != '\0' || tolerance < 0) {
+            fprintf(stderr, "MPIPGO_BALANCE must be tolerance >= 0\n");
+            return -1;
+        }
+    }
+
+    if ((strcmp(mpipgo_algo, "hopbytes") == 0
+         || strcmp(mpipgo_algo, "congestion") == 0) && mpipgo_topo == NULL) {
+        fprintf(stderr, "MPIPGO_TOPO is required by %s\n", mpipgo_algo);
+        return -1;
+    }
+    /* Refinement by swaps and placement on network would move pins */
+    if (mpipgo_pins != NULL && (mpipgo_topo != NULL
+        || (strcmp(mpipgo_algo, "gpart") != 0
+            && strcmp(mpipgo_algo, "bruck") != 0
+            && strcmp(mpipgo_algo, "recdoubling") != 0))) {
+        fprintf(stderr, "MPIPGO_PINS is supported by gpart, bruck and "
+                "recdoubling without MPIPGO_TOPO\n");
+        return -1;
+    }
+    /* Task graphs of collective algorithms are built without profile */
+    if (strcmp(mpipgo_algo, "bruck") == 0
+        || strcmp(mpipgo_algo, "recdoubling") == 0) {
+        if (mpipgo_algo[0] == 'b') {
+            graph = csrgraph_generate_bruck(commsize);
+        } else {
+            graph = csrgraph_generate_recdoubling(commsize);
+        }
+        if (graph == NULL) {
+            fprintf(stderr, "gpart generate error\n");
+            return -1;
+        }
+    } else if (mapping_profile(mpipgo_algo)) {
+        if (g == NULL) {
+            fprintf(stderr, "MPIPGO_GRAPH is required by %s\n", mpipgo_algo);
+            return -1;
+        }
+        graph = csrgraph_load(g);
+        if (graph == NULL) {
+            fprintf(stderr, "gpart load error\n");
+            return -1;
+        }
+        if (graph->nvertices != commsize) {
+            graph = mapping_extrapolate(graph, commsize, mpipgo_extrapolate);
+            if (graph == NULL) {
+                return -1;
+            }
+        }
+    } else if (strcmp(mpipgo_algo, "linear") != 0
+               && strcmp(mpipgo_algo, "rr") != 0) {
+        fprintf(stderr, "MPIPGO_ALGO: unknown algorithm %s\n", mpipgo_algo);
         return -1;
     }
 /*    for (i = 0; i < commsize; i++) {
@@ -87,8 +440,37 @@ int maping_allocate(int commsize, char *g, int *ranks, char *mpipgo_algo)
         printf("pweights[%d] = %d\n", i, pweights[i]);
     }
 */
-    if (strcmp(mpipgo_algo, "gpart") == 0) {
-        if (gpart_partition_recursive(graph, pweights, npart, new_mapp) > 0) {
+    if (mpipgo_pins != NULL) {
+        /* Other processes are partitioned around pinned processes */
+        if ((fixed = mapping_pins(mpipgo_pins, commsize)) == NULL) {
+            return -1;
+        }
+        rc = gpart_partition_fixed(graph, pweights, npart, fixed, new_mapp);
+        if (rc > 0) {
+            fprintf(stderr, "MPIPGO_PINS: more pins than slots of node\n");
+            free(fixed);
+            return -1;
+        }
+    } else if (mapping_profile(mpipgo_algo)) {
+        /* Regular graphs are partitioned in closed form */
+        if (gpart_pattern_detect(graph, &pattern) != 0
+            || gpart_pattern_partition(graph, &pattern, pweights, npart,
+                                       new_mapp) != 0) {
+            if (mapping_gpart(graph, mpipgo_hierarchy) > 0) {
+                fprintf(stderr, "gpart partition error\n");
+                return -1;
+            }
+        }
+        /* Traffic of busiest node instead of total edge cut */
+        if (strcmp(mpipgo_algo, "gpart_minmax") == 0
+            && gpart_refine_minmax(graph, new_mapp, npart, 0) > 0) {
+            fprintf(stderr, "gpart refine error\n");
+            return -1;
+        }
+    } else if (strcmp(mpipgo_algo, "bruck") == 0
+               || strcmp(mpipgo_algo, "recdoubling") == 0) {
+        if (gpart_partition_recursive_regular(graph, pweights, npart,
+                                              new_mapp) > 0) {
             fprintf(stderr, "gpart partition error\n");
             return -1;
         }
@@ -97,32 +479,139 @@ int maping_allocate(int commsize, char *g, int *ranks, char *mpipgo_algo)
     } else if (strcmp(mpipgo_algo, "rr") == 0) {
         rr(npart, pweights, new_mapp, commsize);
     }
+    /* Parts are placed on network, partition is refined by distances */
+    if (graph != NULL && mpipgo_topo != NULL
+        && mapping_nettopo(graph, commsize, mpipgo_topo, mpipgo_algo) != 0) {
+        fprintf(stderr, "MPIPGO_TOPO: mapping error\n");
+        return -1;
+    }
+    /* Compute time and memory of nodes are balanced by swaps */
+    if (mpipgo_balance != NULL) {
+        if (graph == NULL || graph->nvchannels == 0) {
+            fprintf(stderr, "MPIPGO_BALANCE: profile has no vertex "
+                    "weights\n");
+            return -1;
+        }
+        if (gpart_balance_vchannels(graph, new_mapp, npart, fixed,
+                                    tolerance, 0) != 0) {
+            fprintf(stderr, "MPIPGO_BALANCE: balance error\n");
+            return -1;
+        }
+    }
+    free(fixed);
+    if (old_domain != NULL && mapping_level2(graph, commsize) != 0) {
+        fprintf(stderr, "MPIPGO_LEVEL2: partition error\n");
+        return -1;
+    }
+    if (graph != NULL) {
+        csrgraph_free(graph);
+        free(graph);
+    }
+
+    return 0;
+}
+
+int maping_allocate(int commsize, char *g, int *ranks, char *mpipgo_algo,
+                    char *mpipgo_extrapolate, char *mpipgo_cache,
+                    char *mpipgo_hierarchy, char *mpipgo_topo,
+                    char *mpipgo_pins, char *mpipgo_balance)
+{
+    int i = 0, cached = 0;
+    int *part = new_mapp, *partweights = pweights, nparts = npart;
+    int *procparts = old_mapp, *procsubsets = subset_nodes;
+    uint64_t key = 0;
+
+    /* Processes are assigned to groups of second level */
+    if (old_domain != NULL) {
+        part = new_group;
+        partweights = gweights;
+        nparts = ngroups;
+        procparts = old_group;
+        procsubsets = gident;
+    }
+
+    /* Graph is not read for linear and rr, there is nothing to cache */
+    if (mpipgo_cache != NULL && strcmp(mpipgo_algo, "linear") != 0
+        && strcmp(mpipgo_algo, "rr") != 0) {
+        key = mapcache_key(mapping_profile(mpipgo_algo) ? g : NULL,
+                           pweights, npart,
+                           old_domain != NULL ? gweights : NULL, ngroups,
+                           mpipgo_algo, mpipgo_extrapolate, mpipgo_topo,
+                           mpipgo_pins, mpipgo_balance, commsize);
+        cached = (mapcache_load(mpipgo_cache, key, part, commsize,
+                                partweights, nparts) == 0);
+    }
+    if (!cached) {
+        if (mapping_partition(commsize, g, mpipgo_algo, mpipgo_extrapolate,
+                              mpipgo_hierarchy, mpipgo_topo,
+                              mpipgo_pins, mpipgo_balance) != 0) {
+            return -1;
+        }
+        if (key != 0 && mapcache_save(mpipgo_cache, key, part,
+                                      commsize) != 0) {
+            fprintf(stderr, "MPIPGO_CACHE: can not save mapping to %s\n",
+                    mpipgo_cache);
+        }
+    }
 /*    
     for (i = 0; i < commsize; i++) {
         printf("old[%d] = %d || new[%d] = %d \n", i, old_mapp[i], i,
                new_mapp[i]);
     }
 */
-    subsystem = subsystem_init(old_mapp, commsize, npart, pweights,
-                               subset_nodes);
+    subsystem = subsystem_init(procparts, commsize, nparts, partweights,
+                               procsubsets);
     if (subsystem == NULL) {
         return -1;
     }
 //    printf("stage 1\n");
+    /* Process i of application (new rank i) runs on slot of its part */
     for (i = 0; i < commsize; i++) {
-        ranks[subsystem_getproc(subsystem, new_mapp[i])] = i;
+        ranks[i] = subsystem_getproc(subsystem, part[i]);
     }
 /*    for (i = 0; i < commsize; i++) {
         printf("ranks[%d] = %d\n", i, ranks[i]);
     }
 */
-    subsystem_free(subsystem, npart);
+    subsystem_free(subsystem, nparts);
 
     return 0;
 }
+
+/*
+ * mapping_extrapolate: Fit profile graph to pattern and synthesize graph for
+ *                      commsize processes (MPIPGO_EXTRAPOLATE=weak|strong).
+ */
+csrgraph_t *mapping_extrapolate(csrgraph_t *graph, int commsize,
+                                char *mpipgo_extrapolate)
+{
+    gpart_pattern_t pattern;
+    csrgraph_t *scaled = NULL;
+    int scaling;
+
+    if (mpipgo_extrapolate == NULL) {
+        fprintf(stderr, "graph has %d vertices, but commsize is %d "
+                "(set MPIPGO_EXTRAPOLATE)\n", graph->nvertices, commsize);
+    } else if ((scaling = gpart_pattern_scaling(mpipgo_extrapolate)) < 0) {
+        fprintf(stderr, "MPIPGO_EXTRAPOLATE: unknown scaling %s\n",
+                mpipgo_extrapolate);
+    } else if (gpart_pattern_fit(graph, &pattern) != 0) {
+        fprintf(stderr, "graph does not match any pattern, best fit: ");
+        gpart_pattern_print(&pattern, stderr);
+    } else {
+        scaled = gpart_pattern_generate(&pattern, commsize, scaling);
+        if (scaled == NULL) {
+            fprintf(stderr, "gpart pattern generate error\n");
+        }
+    }
+    csrgraph_free(graph);
+    free(graph);
+
+    return scaled;
+}
 void primary_mapp(int rank, int commsize)
 {
-    int my_id;
+    int my_id, my_domain, i;
     
     old_mapp = malloc(sizeof(*old_mapp) * commsize);
     new_mapp = malloc(sizeof(*old_mapp) * commsize);
@@ -131,13 +620,46 @@ void primary_mapp(int rank, int commsize)
         PMPI_Abort(MPI_COMM_WORLD, -1);
     }
     
-    my_id = getnodeid();
+    if (vnodes_map != NULL) {
+        my_id = vnodes_map[rank];
+    } else {
+        my_id = getnodeid();
+    }
     if (rank == 0) {
         PMPI_Gather(&my_id, 1, MPI_INT, old_mapp, 1,
                     MPI_INT, 0, MPI_COMM_WORLD);
     } else {
         PMPI_Gather(&my_id, 1, MPI_INT, NULL, 0, MPI_INT, 0, MPI_COMM_WORLD);
     }
+
+    /* Domains of second level */
+    if (topology_level != TOPOLOGY_NONE) {
+        if (topology_bind_mode != TOPOLOGY_BIND_NONE
+            && topology_bind() != 0) {
+            fprintf(stderr, "MPIPGO_BIND: process %d is not bound\n", rank);
+        }
+        my_domain = topology_domain();
+        if (rank == 0) {
+            if ((old_domain = malloc(sizeof(int) * commsize)) == NULL) {
+                fprintf(stderr, "old_domain error\n");
+                PMPI_Abort(MPI_COMM_WORLD, -1);
+            }
+            PMPI_Gather(&my_domain, 1, MPI_INT, old_domain, 1, MPI_INT, 0,
+                        MPI_COMM_WORLD);
+            for (i = 0; i < commsize; i++) {
+                if (old_domain[i] < 0) {
+                    fprintf(stderr, "MPIPGO_LEVEL2: domain of process %d is "
+                            "unknown, set MPIPGO_BIND\n", i);
+                    free(old_domain);
+                    old_domain = NULL;
+                    break;
+                }
+            }
+        } else {
+            PMPI_Gather(&my_domain, 1, MPI_INT, NULL, 0, MPI_INT, 0,
+                        MPI_COMM_WORLD);
+        }
+    }
 }
 
 void mapping_free()
@@ -146,4 +668,13 @@ void mapping_free()
     free(new_mapp);
     free(subset_nodes);
     free(pweights);
+    if (old_domain != NULL) {
+        free(old_domain);
+        free(old_group);
+        free(new_group);
+        free(gweights);
+        free(gfirst);
+        free(gident);
+        old_domain = NULL;
+    }
 }
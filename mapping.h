@@ -15,28 +15,35 @@
 #include <strings.h>
 #include <time.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <unistd.h>
 
 #include <mpi.h>
 
 #include "subsystem.h"
 #include "gpart/gpart.h"
+#include "gpart/pattern.h"
+#include "gpart/nettopo.h"
 #include "algo.h"
+#include "vnodes.h"
+#include "mapcache.h"
+#include "topology.h"
 
-enum {
-    LENGTH_HOSTNAME = 50,
-};
+extern int *old_mapp, *new_mapp;
+extern int *subset_nodes, *pweights;
+extern int npart;
 
-int *old_mapp, *new_mapp;
-int *subset_nodes, *pweights;
-int npart;
-
-nodes_t *subsystem;
+extern nodes_t *subsystem;
 
 int getnodeid();
 void primary_mapp(int rank, int commsize);
 int mapping_initialize(int commsize);
-int maping_allocate(int commsize, char *graph, int *ranks, char *mpipgo_algo);
+int maping_allocate(int commsize, char *graph, int *ranks, char *mpipgo_algo,
+                    char *mpipgo_extrapolate, char *mpipgo_cache,
+                    char *mpipgo_hierarchy, char *mpipgo_topo,
+                    char *mpipgo_pins, char *mpipgo_balance);
+csrgraph_t *mapping_extrapolate(csrgraph_t *graph, int commsize,
+                                char *mpipgo_extrapolate);
 void mapping_free();
 
 #endif /*MAPPING_H*/
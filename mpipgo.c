@@ -0,0 +1,60 @@
+/*
+ * mpipgo.c: Mode of wrappers library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mpi.h>
+
+#include "mpipgo.h"
+#include "profgenmode.h"
+#include "profusemode.h"
+
+int mpipgo_mode = MPIPGO_MODE_OFF;
+char *mpipgo_graph = NULL;
+
+int mpipgo_select_mode(int defmode)
+{
+    char *name;
+
+    if ((name = getenv("MPIPGO_MODE")) == NULL) {
+        mpipgo_mode = defmode;
+    } else if (strcmp(name, "profgen") == 0) {
+        mpipgo_mode = MPIPGO_MODE_PROFGEN;
+    } else if (strcmp(name, "profuse") == 0) {
+        mpipgo_mode = MPIPGO_MODE_PROFUSE;
+    } else if (strcmp(name, "off") == 0) {
+        mpipgo_mode = MPIPGO_MODE_OFF;
+    } else {
+        mpipgo_mode = MPIPGO_MODE_OFF;
+        return -1;
+    }
+
+    return mpipgo_mode;
+}
+
+void mpipgo_init()
+{
+    if (mpipgo_select_mode(MPIPGO_MODE_DEFAULT) < 0) {
+        fprintf(stderr, "MPIPGO_MODE must be profgen, profuse or off\n");
+        PMPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_init();
+    } else if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        profuse_init();
+    }
+}
+
+int mpipgo_finalize()
+{
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_finalize();
+    } else if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        return profuse_finalize();
+    }
+
+    return PMPI_Finalize();
+}
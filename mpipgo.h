@@ -0,0 +1,40 @@
+/*
+ * mpipgo.h: Mode of wrappers library.
+ *
+ * Mode is selected at MPI_Init by environment variable MPIPGO_MODE
+ * (profgen, profuse or off); if variable is not set, mode of library build
+ * is used (MPIPGO_MODE_DEFAULT).
+ */
+#ifndef MPIPGO_H
+#define MPIPGO_H
+
+enum {
+    MPIPGO_MODE_OFF = 0,        /* Pass-through to PMPI */
+    MPIPGO_MODE_PROFGEN = 1,    /* Generate communication profile */
+    MPIPGO_MODE_PROFUSE = 2     /* Use profile for mapping of processes */
+};
+
+#ifndef MPIPGO_MODE_DEFAULT
+#define MPIPGO_MODE_DEFAULT MPIPGO_MODE_OFF
+#endif
+
+extern int mpipgo_mode;
+extern char *mpipgo_graph;
+
+/*
+ * mpipgo_select_mode: Function sets mpipgo_mode from MPIPGO_MODE or to
+ * defmode. Returns selected mode or -1 for unknown name of mode.
+ */
+int mpipgo_select_mode(int defmode);
+
+/*
+ * mpipgo_init: Function selects mode after PMPI_Init and initializes it.
+ */
+void mpipgo_init();
+
+/*
+ * mpipgo_finalize: Function finalizes mode and calls PMPI_Finalize.
+ */
+int mpipgo_finalize();
+
+#endif /*MPIPGO_H*/
@@ -1,16 +1,55 @@
 #include "profgenmode.h"
+#include "mapping.h"
 
 reqlist_t *reqlist = NULL;
 commtable_t *commtable = NULL;
+int profgen_commsize;
+int profgen_rank;
+double profgen_mpitime = 0.0;
+static double profgen_begin;
+static int profgen_symm = PROFILE_SYMM_SUM;
+static int profgen_format = PROFILE_FORMAT_BIN;
+static MPI_Request *profgen_reqbuf = NULL;
+static int profgen_reqbuf_size = 0;
+
+/*
+ * profgen_save_hierarchy: Coarse graphs of profile are saved to
+ * MPIPGO_HIERARCHY, so profuse mode partitions without coarsening.
+ */
+static void profgen_save_hierarchy(const char *filename)
+{
+    csrgraph_t *graph;
+    gpart_hierarchy_t *h;
+
+    if ((graph = csrgraph_load(mpipgo_graph)) == NULL) {
+        return;
+    }
+    if ((h = gpart_hierarchy_build(graph)) == NULL
+        || gpart_hierarchy_save(h, filename) != 0) {
+        fprintf(stderr, "Can't save hierarchy %s\n", filename);
+    }
+    gpart_hierarchy_free(h);
+    csrgraph_free(graph);
+    free(graph);
+}
 
 void profgenmode_init()
 {
-    fprintf(stderr, "INIT START\n");
     if ((mpipgo_graph = getenv("MPIPGO_GRAPH")) == NULL) {
         fprintf(stderr, "MPIPGO_GRAPH not found\n");
         MPI_Abort(MPI_COMM_WORLD, -1);
     }
     
+    if ((profgen_symm = profile_symm_policy(getenv("MPIPGO_SYMM"))) < 0) {
+        fprintf(stderr, "MPIPGO_SYMM must be sum, max or send\n");
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+    
+    if ((profgen_format = profile_format(getenv("MPIPGO_FORMAT"))) < 0) {
+        fprintf(stderr, "MPIPGO_FORMAT must be bin or text\n");
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+    
     if ((reqlist = reqlist_create()) == NULL) {
         fprintf(stderr, "reqlist has been do not created\n");
         MPI_Abort(MPI_COMM_WORLD, -1);
@@ -30,13 +69,13 @@ void profgenmode_init()
         fprintf(stderr, "commtable\n");
         MPI_Abort(MPI_COMM_WORLD, -1);
     }
-    fprintf(stderr, "INIT FINISH\n");
+    profgen_begin = PMPI_Wtime();
 }
 
 void profgenmode_reg_pt2pt(int count, int partner, MPI_Datatype type,
-                           MPI_Request req)
+                           MPI_Request req, int direction)
 {
-    if (reqlist_add( count, partner, type, req, reqlist) != 1) {
+    if (reqlist_add(count, partner, type, req, direction, reqlist) != 1) {
         fprintf(stderr, "reqlist_add error\n");
         MPI_Abort(MPI_COMM_WORLD, -1);
     }
@@ -47,6 +86,7 @@ void profgenmode_complete_pt2pt_one(MPI_Request req)
     request_t *tmp;
     if ((tmp = reqlist_lookup(req, reqlist)) != NULL) {
         reqlist_elem_complate(&tmp, commtable);
+        reqlist_remove(tmp, reqlist);
 /*        tmp = reqlist_lookup(req, reqlist);
         if (tmp == NULL) {
             printf("tmp = NULL\n");
@@ -64,98 +104,131 @@ void profgenmode_complete_pt2pt_all(MPI_Request *req, int count)
     }
 }
 
+void profgenmode_complete_pt2pt_some(MPI_Request *req, int *indices,
+                                     int count)
+{
+    int i;
+    
+    for (i = 0; i < count; i++) {
+        profgenmode_complete_pt2pt_one(req[indices[i]]);
+    }
+}
+
+MPI_Request *profgenmode_reqbuf(int count)
+{
+    MPI_Request *buf;
+    
+    if (count > profgen_reqbuf_size) {
+        buf = realloc(profgen_reqbuf, sizeof(*buf) * count);
+        if (buf == NULL) {
+            fprintf(stderr, "profgen_reqbuf error\n");
+            MPI_Abort(MPI_COMM_WORLD, -1);
+        }
+        profgen_reqbuf = buf;
+        profgen_reqbuf_size = count;
+    }
+    
+    return profgen_reqbuf;
+}
+
 void profgenmode_finalize()
 {
-    int *vertices, nlink, i, j, nedges, **adjmatr;
-    uint64_t *weight;
-    char symb;
-    FILE *f, *tmp_f;
+    int *vertices, nlink, i, *nlinks = NULL, *displs = NULL, nodeid;
+    uint64_t *sendw, *recvw;
+    int64_t computew, memw;
+    profile_t *profile = NULL;
+    struct rusage usage;
+    
+    /* Vertex weights: time outside MPI and peak memory of process */
+    computew = (int64_t)((PMPI_Wtime() - profgen_begin - profgen_mpitime)
+                         * 1e6);
+    if (computew < 0) {
+        computew = 0;
+    }
+    memw = (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : 0;
+    nodeid = getnodeid();
     
-    printf("FINALIZE\n");
-    commtable_print(profgen_rank, commtable);
     vertices = malloc(sizeof(*vertices) * profgen_commsize);
-    weight = malloc(sizeof(weight) * profgen_commsize);
-    if (vertices == NULL || weight == NULL) {
+    sendw = malloc(sizeof(*sendw) * profgen_commsize);
+    recvw = malloc(sizeof(*recvw) * profgen_commsize);
+    if (vertices == NULL || sendw == NULL || recvw == NULL) {
         fprintf(stderr, "vertices | weight error\n");
         PMPI_Abort(MPI_COMM_WORLD, -1);
     }
+    commtable_fill_vectors(commtable, vertices, sendw, recvw, &nlink);
+    for (i = 0; i < nlink; i++) {
+        vertices[i]--;
+    }
     
-    commtable_fill_vectors(commtable, vertices, weight, &nlink);
-    if (profgen_rank != 0) {
-        PMPI_Send(&nlink, 1, MPI_INT, 0, profgen_rank, MPI_COMM_WORLD);
-        PMPI_Send(vertices, nlink, MPI_INT, 0, profgen_rank * 10,
-                  MPI_COMM_WORLD);
-        PMPI_Send(weight, nlink, MPI_UINT64_T, 0, profgen_rank * 100,
-                 MPI_COMM_WORLD);
-    } else {
-        adjmatr = malloc(sizeof(*adjmatr) * profgen_commsize);
+    if (profgen_rank == 0) {
+        nlinks = malloc(sizeof(*nlinks) * profgen_commsize);
+        displs = malloc(sizeof(*displs) * profgen_commsize);
+        if (nlinks == NULL || displs == NULL) {
+            fprintf(stderr, "nlinks | displs error\n");
+            PMPI_Abort(MPI_COMM_WORLD, -1);
+        }
+    }
+    PMPI_Gather(&nlink, 1, MPI_INT, nlinks, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (profgen_rank == 0) {
+        for (i = 0, displs[0] = 0; i < profgen_commsize - 1; i++) {
+            displs[i + 1] = displs[i] + nlinks[i];
+        }
+        profile = profile_create(profgen_commsize,
+                                 displs[profgen_commsize - 1]
+                                 + nlinks[profgen_commsize - 1]);
+        if (profile == NULL) {
+            fprintf(stderr, "profile error\n");
+            PMPI_Abort(MPI_COMM_WORLD, -1);
+        }
         for (i = 0; i < profgen_commsize; i++) {
-            adjmatr[i] = malloc(sizeof(*adjmatr[i]) * profgen_commsize);
-            bzero(adjmatr[i], sizeof(*adjmatr[i]) * profgen_commsize);
+            profile->adjindexes[i] = displs[i];
         }
-        
-        if ((tmp_f = fopen(".tmp", "w+")) != NULL) {
-            for (i = 0; i < nlink; i++) {
-                adjmatr[0][vertices[i] - 1] = 1;
-                fprintf(tmp_f, "%d %" PRIu64 " ", vertices[i], weight[i]);
-            }
-            fprintf(tmp_f, "\n");
-            for (i = 1; i < profgen_commsize; i++) {
-                bzero(vertices, sizeof(*vertices) * profgen_commsize);
-                bzero(weight, sizeof(*weight) * profgen_commsize);
-                
-                if (MPI_Recv(&nlink, 1, MPI_INT, i, i, MPI_COMM_WORLD,
-                             MPI_STATUS_IGNORE) != MPI_SUCCESS) {
-                    break;
-                }
-                
-                if (MPI_Recv(vertices, nlink, MPI_INT, i, i * 10,
-                             MPI_COMM_WORLD,
-                             MPI_STATUS_IGNORE) != MPI_SUCCESS) {
-                    break;
-                }
-                
-                if (MPI_Recv(weight, nlink, MPI_UNSIGNED_LONG, i, i * 100,
-                             MPI_COMM_WORLD,
-                             MPI_STATUS_IGNORE) != MPI_SUCCESS) {
-                    break;
-                }
-                
-                for (j = 0; j < nlink; j++) {
-                    adjmatr[i][vertices[j] - 1] = 1;
-                    fprintf(tmp_f, "%d %" PRIu64 " ", vertices[j],
-                            weight[j]);
-                }
-                fprintf(tmp_f, "\n");                    
-            }
-            /*  */
-            for (i = 0, nedges = 0; i < profgen_commsize; i++) {
-                for (j = 0; j < i; j++) {
-                    if (adjmatr[i][j] == 1) {
-                        nedges++;
-                    }
-                }
-            }
-            
-            if ((f = fopen(mpipgo_graph, "w+")) != NULL) {
-                fseek(tmp_f, 0, SEEK_SET);
-                fprintf(f, "%d %d 11\n", profgen_commsize, nedges);
-                while (!feof(tmp_f)) {
-                    fscanf(tmp_f, "%c", &symb);
-                    fprintf(f, "%c", symb);
-                }
-            }
-            fclose(f);
-            fclose(tmp_f);
-            for (i =0; i < profgen_commsize; i++) {
-                free(adjmatr[i]);
+        profile->adjindexes[profgen_commsize] = profile->nentries;
+    }
+    
+    /* Rows of profile: partners, sent and received volumes */
+    PMPI_Gatherv(vertices, nlink, MPI_INT,
+                 profile ? profile->adjv : NULL, nlinks, displs, MPI_INT,
+                 0, MPI_COMM_WORLD);
+    PMPI_Gatherv(sendw, nlink, MPI_UINT64_T,
+                 profile ? profile->sendw : NULL, nlinks, displs,
+                 MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    PMPI_Gatherv(recvw, nlink, MPI_UINT64_T,
+                 profile ? profile->recvw : NULL, nlinks, displs,
+                 MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    PMPI_Gather(&computew, 1, MPI_INT64_T,
+                profile ? profile->computew : NULL, 1, MPI_INT64_T, 0,
+                MPI_COMM_WORLD);
+    PMPI_Gather(&memw, 1, MPI_INT64_T, profile ? profile->memw : NULL, 1,
+                MPI_INT64_T, 0, MPI_COMM_WORLD);
+    
+    /* Node layout of job: nodes are numbered in order of lowest rank */
+    PMPI_Gather(&nodeid, 1, MPI_INT, profile ? profile->nodemap : NULL, 1,
+                MPI_INT, 0, MPI_COMM_WORLD);
+    if (profile != NULL) {
+        for (i = 0; i < profgen_commsize; i++) {
+            if (profile->nodemap[i] >= profile->nnodes) {
+                profile->nnodes = profile->nodemap[i] + 1;
             }
-            free(adjmatr);
-            remove(".tmp");
-        }    
+        }
+    }
+    
+    if (profgen_rank == 0) {
+        if (profile_save(profile, profgen_symm, profgen_format,
+                         mpipgo_graph) != 0) {
+            fprintf(stderr, "Can't save profile %s\n", mpipgo_graph);
+        } else if (getenv("MPIPGO_HIERARCHY") != NULL) {
+            profgen_save_hierarchy(getenv("MPIPGO_HIERARCHY"));
+        }
+        profile_free(profile);
+        free(nlinks);
+        free(displs);
     }
-
     
     free(vertices);
-    free(weight);
+    free(sendw);
+    free(recvw);
+    free(profgen_reqbuf);
+    profgen_reqbuf = NULL;
+    profgen_reqbuf_size = 0;
 }
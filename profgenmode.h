@@ -7,18 +7,38 @@
 
 #include <stdio.h>
 #include <strings.h>
+#include <sys/resource.h>
 
 #include <mpi.h>
 
 #include "reqlist.h"
 #include "communication.h"
+#include "profile.h"
+#include "mpipgo.h"
+#include "gpart/gpart.h"
 
 /*reqlist_t *reqlist = NULL;*/
 /*commtable_t *commtable = NULL;*/
 
-char *mpipgo_graph;
-int profgen_commsize;
-int profgen_rank;
+extern int profgen_commsize;
+extern int profgen_rank;
+extern double profgen_mpitime;
+
+/*
+ * profgen_enter, profgen_leave: Time of MPI call is accumulated in
+ * profgen_mpitime; compute time of process is time outside MPI calls.
+ */
+static inline double profgen_enter()
+{
+    return (mpipgo_mode == MPIPGO_MODE_PROFGEN) ? PMPI_Wtime() : 0.0;
+}
+
+static inline void profgen_leave(double begin)
+{
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgen_mpitime += PMPI_Wtime() - begin;
+    }
+}
 
 /* 
  * profgenmode_init: Funtion initializes profgen mode.
@@ -26,9 +46,10 @@ int profgen_rank;
 void profgenmode_init();
 /* 
  * profgenmode_reg_pt2pt: Function adds request to list of requests.
+ * direction is COMMTABLE_SEND or COMMTABLE_RECV.
  */
 void profgenmode_reg_pt2pt(int count, int partner, MPI_Datatype type,
-                           MPI_Request req);
+                           MPI_Request req, int direction);
 /*
  * profgenmode_complete_pt2pt_one: Function to complete pt2pt operation for 
  * one request.
@@ -39,7 +60,26 @@ void profgenmode_complete_pt2pt_one(MPI_Request req);
  * all request.
  */
 void profgenmode_complete_pt2pt_all(MPI_Request *req, int count);
+/*
+ * profgenmode_complete_pt2pt_some: Function completes requests req[i] for
+ * every i in indices (0-based).
+ */
+void profgenmode_complete_pt2pt_some(MPI_Request *req, int *indices,
+                                     int count);
+/*
+ * profgenmode_reqbuf: Function returns buffer of at least count requests.
+ * Test* and Wait* functions set completed requests to MPI_REQUEST_NULL,
+ * so wrappers copy handles to buffer before the call. Buffer is reused
+ * by next call.
+ */
+MPI_Request *profgenmode_reqbuf(int count);
 
+/*
+ * profgenmode_finalize: Function gathers profile on process 0 and saves it
+ * to file MPIPGO_GRAPH. Policy of symmetrization is MPIPGO_SYMM
+ * (sum, max or send), format of file is MPIPGO_FORMAT (bin or text).
+ * Compute time and peak resident set size of processes are vertex weights.
+ */
 void profgenmode_finalize();
 
 #endif /*PROFGEN_MODE_*/
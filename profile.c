@@ -0,0 +1,391 @@
+/*
+ * profile.c: Communication profile of application.
+ */
+
+#include <limits.h>
+
+#include "profile.h"
+
+static int profile_save_text(profile_t *p, int policy, const char *filename);
+static int profile_save_bin(profile_t *p, int policy, const char *filename);
+static int profile_write_at(FILE *f, uint64_t offset, const void *data,
+                            size_t size);
+
+profile_t *profile_create(int nvertices, int nentries)
+{
+    profile_t *p;
+
+    if ((p = malloc(sizeof(*p))) == NULL) {
+        return NULL;
+    }
+    p->nvertices = nvertices;
+    p->nentries = nentries;
+    p->adjindexes = malloc(sizeof(*p->adjindexes) * (nvertices + 1));
+    p->adjv = malloc(sizeof(*p->adjv) * (nentries + 1));
+    p->sendw = malloc(sizeof(*p->sendw) * (nentries + 1));
+    p->recvw = malloc(sizeof(*p->recvw) * (nentries + 1));
+    p->computew = calloc(nvertices + 1, sizeof(*p->computew));
+    p->memw = calloc(nvertices + 1, sizeof(*p->memw));
+    p->nnodes = 0;
+    p->nodemap = calloc(nvertices + 1, sizeof(*p->nodemap));
+    if (p->adjindexes == NULL || p->adjv == NULL || p->sendw == NULL
+        || p->recvw == NULL || p->computew == NULL || p->memw == NULL
+        || p->nodemap == NULL) {
+        profile_free(p);
+        return NULL;
+    }
+
+    return p;
+}
+
+void profile_free(profile_t *p)
+{
+    if (p != NULL) {
+        free(p->adjindexes);
+        free(p->adjv);
+        free(p->sendw);
+        free(p->recvw);
+        free(p->computew);
+        free(p->memw);
+        free(p->nodemap);
+        free(p);
+    }
+}
+
+int profile_symm_policy(const char *name)
+{
+    if (name == NULL || strcmp(name, "sum") == 0) {
+        return PROFILE_SYMM_SUM;
+    } else if (strcmp(name, "max") == 0) {
+        return PROFILE_SYMM_MAX;
+    } else if (strcmp(name, "send") == 0) {
+        return PROFILE_SYMM_SEND;
+    }
+
+    return -1;
+}
+
+int profile_format(const char *name)
+{
+    if (name == NULL || strcmp(name, "bin") == 0) {
+        return PROFILE_FORMAT_BIN;
+    } else if (strcmp(name, "text") == 0) {
+        return PROFILE_FORMAT_TEXT;
+    }
+
+    return -1;
+}
+
+int profile_symmetrize(profile_t *p, int policy, int **adjindexes,
+                       int **adjv, uint64_t **edges, uint64_t **sendw,
+                       uint64_t **recvw, int *nedges)
+{
+    int n = p->nvertices, i, j, k, kend, t, tend, m;
+    int *tindexes, *tadjv, *pos;
+    uint64_t *tsend, *trecv, sij, rij, sji, rji, dij, dji, w;
+
+    tindexes = calloc(n + 1, sizeof(*tindexes));
+    pos = malloc(sizeof(*pos) * (n + 1));
+    tadjv = malloc(sizeof(*tadjv) * (p->nentries + 1));
+    tsend = malloc(sizeof(*tsend) * (p->nentries + 1));
+    trecv = malloc(sizeof(*trecv) * (p->nentries + 1));
+    *adjindexes = malloc(sizeof(**adjindexes) * (n + 1));
+    *adjv = malloc(sizeof(**adjv) * (2 * p->nentries + 1));
+    *edges = malloc(sizeof(**edges) * (2 * p->nentries + 1));
+    if (sendw != NULL && recvw != NULL) {
+        *sendw = malloc(sizeof(**sendw) * (2 * p->nentries + 1));
+        *recvw = malloc(sizeof(**recvw) * (2 * p->nentries + 1));
+    }
+    if (tindexes == NULL || pos == NULL || tadjv == NULL || tsend == NULL
+        || trecv == NULL || *adjindexes == NULL || *adjv == NULL
+        || *edges == NULL || (sendw != NULL && recvw != NULL
+                              && (*sendw == NULL || *recvw == NULL))) {
+        free(tindexes);
+        free(pos);
+        free(tadjv);
+        free(tsend);
+        free(trecv);
+        free(*adjindexes);
+        free(*adjv);
+        free(*edges);
+        if (sendw != NULL && recvw != NULL) {
+            free(*sendw);
+            free(*recvw);
+        }
+        return 1;
+    }
+
+    /* Transpose profile: row j of transposed profile lists senders to j */
+    for (k = 0; k < p->nentries; k++) {
+        tindexes[p->adjv[k] + 1]++;
+    }
+    for (i = 0; i < n; i++) {
+        tindexes[i + 1] += tindexes[i];
+        pos[i] = tindexes[i];
+    }
+    for (i = 0; i < n; i++) {
+        for (k = p->adjindexes[i]; k < p->adjindexes[i + 1]; k++) {
+            t = pos[p->adjv[k]]++;
+            tadjv[t] = i;
+            tsend[t] = p->sendw[k];
+            trecv[t] = p->recvw[k];
+        }
+    }
+
+    /* Merge row i of profile with row i of transposed profile */
+    for (i = 0, m = 0; i < n; i++) {
+        (*adjindexes)[i] = m;
+        k = p->adjindexes[i];
+        kend = p->adjindexes[i + 1];
+        t = tindexes[i];
+        tend = tindexes[i + 1];
+        while (k < kend || t < tend) {
+            sij = rij = sji = rji = 0;
+            if (t == tend || (k < kend && p->adjv[k] < tadjv[t])) {
+                j = p->adjv[k];
+                sij = p->sendw[k];
+                rij = p->recvw[k];
+                k++;
+            } else if (k == kend || tadjv[t] < p->adjv[k]) {
+                j = tadjv[t];
+                sji = tsend[t];
+                rji = trecv[t];
+                t++;
+            } else {
+                j = p->adjv[k];
+                sij = p->sendw[k];
+                rij = p->recvw[k];
+                sji = tsend[t];
+                rji = trecv[t];
+                k++;
+                t++;
+            }
+            if (j == i) {
+                continue;
+            }
+
+            dij = (sij > 0) ? sij : rji;
+            dji = (sji > 0) ? sji : rij;
+            if (policy == PROFILE_SYMM_MAX) {
+                w = (dij > dji) ? dij : dji;
+            } else if (policy == PROFILE_SYMM_SEND) {
+                w = sij + sji;
+            } else {
+                w = dij + dji;
+            }
+
+            if (w > 0) {
+                (*adjv)[m] = j;
+                (*edges)[m] = w;
+                if (sendw != NULL && recvw != NULL) {
+                    (*sendw)[m] = sij;
+                    (*recvw)[m] = rij;
+                }
+                m++;
+            }
+        }
+    }
+    (*adjindexes)[n] = m;
+    *nedges = m;
+
+    free(tindexes);
+    free(pos);
+    free(tadjv);
+    free(tsend);
+    free(trecv);
+
+    return 0;
+}
+
+int profile_save(profile_t *p, int policy, int format, const char *filename)
+{
+    if (format == PROFILE_FORMAT_BIN) {
+        return profile_save_bin(p, policy, filename);
+    }
+
+    return profile_save_text(p, policy, filename);
+}
+
+static int profile_save_text(profile_t *p, int policy, const char *filename)
+{
+    int *adjindexes, *adjv, nedges, i, k;
+    uint64_t *edges;
+    char *dirname, *vwname;
+    FILE *f;
+
+    if (profile_symmetrize(p, policy, &adjindexes, &adjv, &edges, NULL, NULL,
+                           &nedges) != 0) {
+        return 1;
+    }
+
+    if ((f = fopen(filename, "w")) == NULL) {
+        free(adjindexes);
+        free(adjv);
+        free(edges);
+        return 1;
+    }
+    fprintf(f, "%d %d 1\n", p->nvertices, nedges / 2);
+    for (i = 0; i < p->nvertices; i++) {
+        for (k = adjindexes[i]; k < adjindexes[i + 1]; k++) {
+            /* Weights of edges are int in gpart */
+            fprintf(f, "%d %" PRIu64 " ", adjv[k] + 1,
+                    (edges[k] > INT_MAX) ? (uint64_t)INT_MAX : edges[k]);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    free(adjindexes);
+    free(adjv);
+    free(edges);
+
+    /* Directed volumes: partner, sent bytes, received bytes */
+    if ((dirname = malloc(strlen(filename) + sizeof(".dir"))) == NULL) {
+        return 1;
+    }
+    sprintf(dirname, "%s.dir", filename);
+    f = fopen(dirname, "w");
+    free(dirname);
+    if (f == NULL) {
+        return 1;
+    }
+    fprintf(f, "%d %d 2\n", p->nvertices, p->nentries);
+    for (i = 0; i < p->nvertices; i++) {
+        for (k = p->adjindexes[i]; k < p->adjindexes[i + 1]; k++) {
+            fprintf(f, "%d %" PRIu64 " %" PRIu64 " ", p->adjv[k] + 1,
+                    p->sendw[k], p->recvw[k]);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+
+    /* Vertex weights: compute time (us) and peak memory (KB) */
+    if ((vwname = malloc(strlen(filename) + sizeof(".vw"))) == NULL) {
+        return 1;
+    }
+    sprintf(vwname, "%s.vw", filename);
+    f = fopen(vwname, "w");
+    free(vwname);
+    if (f == NULL) {
+        return 1;
+    }
+    fprintf(f, "%d 2\n", p->nvertices);
+    for (i = 0; i < p->nvertices; i++) {
+        fprintf(f, "%" PRId64 " %" PRId64 "\n", p->computew[i], p->memw[i]);
+    }
+    fclose(f);
+
+    return 0;
+}
+
+static int profile_save_bin(profile_t *p, int policy, const char *filename)
+{
+    int *adjindexes, *adjv, nedges, k, rc = 0;
+    int32_t *weights;
+    uint64_t *edges, *sendw, *recvw;
+    csrbin_header_t h;
+    FILE *f;
+
+    if (profile_symmetrize(p, policy, &adjindexes, &adjv, &edges, &sendw,
+                           &recvw, &nedges) != 0) {
+        return 1;
+    }
+
+    /* Weights of edges are int in gpart */
+    if ((weights = malloc(sizeof(*weights) * (nedges + 1))) == NULL) {
+        rc = 1;
+        goto errhandler;
+    }
+    for (k = 0; k < nedges; k++) {
+        weights[k] = (edges[k] > INT_MAX) ? INT_MAX : (int32_t)edges[k];
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CSRBIN_MAGIC, CSRBIN_MAGIC_LEN);
+    h.version = CSRBIN_VERSION;
+    h.headersize = sizeof(h);
+    h.nvertices = p->nvertices;
+    h.nadj = nedges;
+    h.nechannels = 3;
+    h.off_adjindexes = CSRBIN_ALIGNUP(sizeof(h));
+    h.off_adjv = CSRBIN_ALIGNUP(h.off_adjindexes
+                                + sizeof(int32_t) * (h.nvertices + 1));
+    h.off_echannels[CSRBIN_ECHANNEL_WEIGHT] =
+        CSRBIN_ALIGNUP(h.off_adjv + sizeof(int32_t) * h.nadj);
+    h.off_echannels[CSRBIN_ECHANNEL_SEND] =
+        CSRBIN_ALIGNUP(h.off_echannels[CSRBIN_ECHANNEL_WEIGHT]
+                       + sizeof(int32_t) * h.nadj);
+    h.off_echannels[CSRBIN_ECHANNEL_RECV] =
+        CSRBIN_ALIGNUP(h.off_echannels[CSRBIN_ECHANNEL_SEND]
+                       + sizeof(uint64_t) * h.nadj);
+    h.nvchannels = 2;
+    h.off_vchannels[CSRBIN_VCHANNEL_COMPUTE] =
+        CSRBIN_ALIGNUP(h.off_echannels[CSRBIN_ECHANNEL_RECV]
+                       + sizeof(uint64_t) * h.nadj);
+    h.off_vchannels[CSRBIN_VCHANNEL_RSS] =
+        CSRBIN_ALIGNUP(h.off_vchannels[CSRBIN_VCHANNEL_COMPUTE]
+                       + sizeof(int64_t) * h.nvertices);
+    h.filesize = h.off_vchannels[CSRBIN_VCHANNEL_RSS]
+                 + sizeof(int64_t) * h.nvertices;
+    if (p->nnodes > 0) {
+        h.nnodes = p->nnodes;
+        h.off_nodemap = CSRBIN_ALIGNUP(h.filesize);
+        h.filesize = h.off_nodemap + sizeof(int32_t) * h.nvertices;
+    }
+
+    if ((f = fopen(filename, "w")) == NULL) {
+        rc = 1;
+        goto errhandler;
+    }
+    rc += profile_write_at(f, 0, &h, sizeof(h));
+    rc += profile_write_at(f, h.off_adjindexes, adjindexes,
+                           sizeof(int32_t) * (h.nvertices + 1));
+    rc += profile_write_at(f, h.off_adjv, adjv, sizeof(int32_t) * h.nadj);
+    rc += profile_write_at(f, h.off_echannels[CSRBIN_ECHANNEL_WEIGHT],
+                           weights, sizeof(int32_t) * h.nadj);
+    rc += profile_write_at(f, h.off_echannels[CSRBIN_ECHANNEL_SEND], sendw,
+                           sizeof(uint64_t) * h.nadj);
+    rc += profile_write_at(f, h.off_echannels[CSRBIN_ECHANNEL_RECV], recvw,
+                           sizeof(uint64_t) * h.nadj);
+    rc += profile_write_at(f, h.off_vchannels[CSRBIN_VCHANNEL_COMPUTE],
+                           p->computew, sizeof(int64_t) * h.nvertices);
+    rc += profile_write_at(f, h.off_vchannels[CSRBIN_VCHANNEL_RSS], p->memw,
+                           sizeof(int64_t) * h.nvertices);
+    if (p->nnodes > 0) {
+        rc += profile_write_at(f, h.off_nodemap, p->nodemap,
+                               sizeof(int32_t) * h.nvertices);
+    }
+    if (fclose(f) != 0) {
+        rc++;
+    }
+
+errhandler:
+    free(adjindexes);
+    free(adjv);
+    free(edges);
+    free(sendw);
+    free(recvw);
+    free(weights);
+
+    return rc > 0 ? 1 : 0;
+}
+
+/* profile_write_at: Write data at offset of file, gap is filled by zeros. */
+static int profile_write_at(FILE *f, uint64_t offset, const void *data,
+                            size_t size)
+{
+    long pos;
+
+    if ((pos = ftell(f)) < 0) {
+        return 1;
+    }
+    for ( ; (uint64_t)pos < offset; pos++) {
+        if (fputc(0, f) == EOF) {
+            return 1;
+        }
+    }
+    if (size > 0 && fwrite(data, 1, size, f) != size) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * profile.h: Communication profile of application.
+ *
+ * Profile keeps volumes of sent and received messages separately:
+ * row i contains partners of process i with number of bytes sent by i to
+ * partner and received by i from partner. Symmetrization pass builds
+ * undirected graph in CSR format (see gpart/gpart.h) from directed volumes.
+ * Compute time and peak memory of processes are vertex weights of graph.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "gpart/csrbin.h"
+
+/* Policy of symmetrization: weight of edge (i, j) */
+enum {
+    PROFILE_SYMM_SUM = 0,   /* Volume i -> j plus volume j -> i */
+    PROFILE_SYMM_MAX = 1,   /* Max of volumes i -> j and j -> i */
+    PROFILE_SYMM_SEND = 2   /* Sum of volumes registered by senders only */
+};
+
+/* Format of profile file */
+enum {
+    PROFILE_FORMAT_TEXT = 0,    /* CSR text format and <filename>.dir */
+    PROFILE_FORMAT_BIN = 1      /* Binary CSR format (gpart/csrbin.h) */
+};
+
+typedef struct profile profile_t;
+struct profile {
+    int nvertices;
+    int nentries;
+    int *adjindexes;        /* Row i is [adjindexes[i], adjindexes[i + 1]) */
+    int *adjv;              /* Partners (0-based), sorted in every row */
+    uint64_t *sendw;        /* Bytes sent by i to partner */
+    uint64_t *recvw;        /* Bytes received by i from partner */
+    int64_t *computew;      /* Time of i outside MPI, microseconds */
+    int64_t *memw;          /* Peak resident set size of i, KB */
+    int nnodes;             /* Number of nodes of job or 0 */
+    int *nodemap;           /* Node of i (numbered by lowest rank) */
+};
+
+profile_t *profile_create(int nvertices, int nentries);
+void profile_free(profile_t *p);
+
+/* profile_symm_policy: Return policy by name (sum, max, send) or -1. */
+int profile_symm_policy(const char *name);
+
+/* profile_format: Return format by name (text, bin) or -1. */
+int profile_format(const char *name);
+
+/*
+ * profile_symmetrize: Build undirected graph from directed profile.
+ * Volume i -> j is taken from row of sender i or, if sender missed message,
+ * from row of receiver j. Arrays adjindexes, adjv and edges are allocated
+ * by function; number of edges (2 * number of undirected edges) is
+ * returned in nedges. If sendw and recvw are not NULL, directed volumes of
+ * every edge (sent and received by row vertex) are returned in them.
+ * Return 0 on success and 1 otherwise.
+ */
+int profile_symmetrize(profile_t *p, int policy, int **adjindexes,
+                       int **adjv, uint64_t **edges, uint64_t **sendw,
+                       uint64_t **recvw, int *nedges);
+
+/*
+ * profile_save: Save symmetrized graph to file. Text format keeps directed
+ * volumes in file <filename>.dir and vertex weights in <filename>.vw,
+ * binary format keeps them in weight channels of graph file, together
+ * with node of every process if nnodes > 0.
+ * Return 0 on success and 1 otherwise.
+ */
+int profile_save(profile_t *p, int policy, int format, const char *filename);
+
+#endif /* PROFILE_H */
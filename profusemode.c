@@ -3,10 +3,71 @@
 
 MPI_Comm newcomm;
 MPI_Group worldgrouup, newgroup;
+char *mpipgo_algo;
+char *mpipgo_extrapolate;
+char *mpipgo_cache;
+char *mpipgo_hierarchy;
+char *mpipgo_topo;
+char *mpipgo_pins;
+char *mpipgo_balance;
+int profuse_commsize;
+int profuse_rank;
+int profuse_worldrank;
+int profuse_keyval = MPI_KEYVAL_INVALID;
+double mapp_begin, mapp_end, test_begin, test_end;
+MPI_Fint profuse_fworld, profuse_fnewcomm;
+
+static int profuse_worldranks_delete(MPI_Comm comm, int keyval, void *attr,
+                                     void *extra)
+{
+    free(attr);
+
+    return MPI_SUCCESS;
+}
+
+int *profuse_worldranks(MPI_Comm comm)
+{
+    MPI_Group group, worldgroup;
+    int *worldranks, *ranks, size, flag, i;
+
+    PMPI_Comm_get_attr(comm, profuse_keyval, &worldranks, &flag);
+    if (flag) {
+        return worldranks;
+    }
+    /* Destination of intercommunicator is rank of remote group */
+    PMPI_Comm_test_inter(comm, &flag);
+    if (flag) {
+        PMPI_Comm_remote_group(comm, &group);
+    } else {
+        PMPI_Comm_group(comm, &group);
+    }
+    PMPI_Group_size(group, &size);
+    worldranks = malloc(sizeof(int) * (size + 1));
+    ranks = malloc(sizeof(int) * size);
+    if (worldranks == NULL || ranks == NULL) {
+        free(worldranks);
+        free(ranks);
+        PMPI_Group_free(&group);
+        return NULL;
+    }
+    for (i = 0; i < size; i++) {
+        ranks[i] = i;
+    }
+    PMPI_Comm_group(MPI_COMM_WORLD, &worldgroup);
+    PMPI_Group_translate_ranks(group, size, ranks, worldgroup,
+                               worldranks + 1);
+    PMPI_Group_free(&worldgroup);
+    PMPI_Group_free(&group);
+    free(ranks);
+    worldranks[0] = size;
+    PMPI_Comm_set_attr(comm, profuse_keyval, worldranks);
+
+    return worldranks;
+}
 
 void profuse_init()
 {
-    int *ranks, old_rank;
+    int *ranks;
     
     if(PMPI_Comm_size(MPI_COMM_WORLD, &profuse_commsize) != MPI_SUCCESS) {
         fprintf(stderr, "profuse_commsize\n");
@@ -16,15 +77,31 @@ void profuse_init()
         fprintf(stderr, "profuse_rank\n");
         PMPI_Abort(MPI_COMM_WORLD, -1);
     }
-    if ((mpipgo_graph = getenv("MPIPGO_GRAPH")) == NULL) {
-        fprintf(stderr, "MPIPGO_GRAPH\n");
-        PMPI_Abort(MPI_COMM_WORLD, 1);
-    }
+    /* Graph is not needed by bruck, recdoubling, linear and rr */
+    mpipgo_graph = getenv("MPIPGO_GRAPH");
     
     if ((mpipgo_algo = getenv("MPIPGO_ALGO")) == NULL) {
         fprintf(stderr, "MPIPGO_ALGO\n");
         PMPI_Abort(MPI_COMM_WORLD, 1);
     }
+    mpipgo_extrapolate = getenv("MPIPGO_EXTRAPOLATE");
+    mpipgo_cache = getenv("MPIPGO_CACHE");
+    mpipgo_hierarchy = getenv("MPIPGO_HIERARCHY");
+    mpipgo_topo = getenv("MPIPGO_TOPO");
+    mpipgo_pins = getenv("MPIPGO_PINS");
+    mpipgo_balance = getenv("MPIPGO_BALANCE");
+    if (topology_init(getenv("MPIPGO_LEVEL2")) != 0) {
+        fprintf(stderr, "MPIPGO_LEVEL2 must be socket, numa or l3\n");
+        PMPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (topology_bind_init(getenv("MPIPGO_BIND")) != 0) {
+        fprintf(stderr, "MPIPGO_BIND must be core or domain\n");
+        PMPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (vnodes_init(profuse_commsize) < 0) {
+        fprintf(stderr, "virtual nodes error\n");
+        PMPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
     if ((ranks = malloc(sizeof(int) * profuse_commsize)) == NULL) {
         fprintf(stderr, "profuse ranks error\n");
@@ -37,7 +114,10 @@ void profuse_init()
     if (profuse_rank == 0) {
         mapping_initialize(profuse_commsize);
         if(maping_allocate(profuse_commsize, mpipgo_graph, ranks,
-                           mpipgo_algo) != 0) {
+                           mpipgo_algo, mpipgo_extrapolate,
+                           mpipgo_cache, mpipgo_hierarchy,
+                           mpipgo_topo, mpipgo_pins,
+                           mpipgo_balance) != 0) {
             fprintf(stderr, "mapping allocate error\n");
             PMPI_Abort(MPI_COMM_WORLD, -1);
         }
@@ -48,10 +128,18 @@ void profuse_init()
     PMPI_Group_incl(worldgrouup, profuse_commsize, ranks, &newgroup);
     PMPI_Comm_create(MPI_COMM_WORLD, newgroup, &newcomm);
     free(ranks);
+    /* World ranks of communicators are needed by delays of virtual nodes */
+    if (vnodes_shim) {
+        PMPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN,
+                                profuse_worldranks_delete, &profuse_keyval,
+                                NULL);
+    }
     PMPI_Group_free(&worldgrouup);
-    old_rank = profuse_rank;
+    profuse_worldrank = profuse_rank;
     PMPI_Comm_rank(newcomm, &profuse_rank);
-//    printf("Now process %d is %d/%d\n",old_rank, profuse_rank,
+    profuse_fworld = MPI_Comm_c2f(MPI_COMM_WORLD);
+    profuse_fnewcomm = MPI_Comm_c2f(newcomm);
+//    printf("Now process %d is %d/%d\n",profuse_worldrank, profuse_rank,
 //           profuse_commsize);
     PMPI_Barrier(newcomm);
     if (profuse_rank == 0) {
@@ -59,165 +147,6 @@ void profuse_init()
         test_begin = MPI_Wtime();
     }
 }
-int profuse_comm_size(MPI_Comm comm, int *size)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT ) {
-        rc = MPI_Comm_size(newcomm, size);
-    } else {
-        rc = MPI_Comm_size( comm, size );
-    }
-    
-    return rc;
-}
-
-int profuse_comm_rank(MPI_Comm comm, int *rank)
-{
-    int rc;
-    
-    MPI_Comm_compare(comm, MPI_COMM_WORLD, &rc);
-    if (rc != MPI_IDENT) {
-        rc = MPI_Comm_rank(comm, rank);
-    } else {
-        rc = MPI_Comm_rank(newcomm, rank);
-    }
-    
-    return rc;
-}
-
-int profuse_abort(MPI_Comm comm, int errcode)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Abort(newcomm, errcode);
-    } else {
-        rc = MPI_Abort(comm, errcode);
-    }
-    
-    return rc;
-}
-
-int profuse_comm_split(MPI_Comm comm, int color, int key, MPI_Comm *newcomm_)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Comm_split(newcomm, color, key, newcomm_);
-    } else {
-        rc = MPI_Comm_split(comm, color, key, newcomm_);
-    }
-    
-    return rc;
-}
-
-int profuse_comm_dup(MPI_Comm comm, MPI_Comm *newcomm_)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Comm_dup(newcomm, newcomm_);
-    } else {
-        rc = MPI_Comm_dup(comm, newcomm_);
-    }
-    
-    return rc;
-}
-
-int profuse_reduce(void *sendbuf, void *recvbuf, int count,
-                   MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, newcomm);
-    } else {
-        rc = MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
-    }
-    
-    return rc;
-}
-
-int profuse_allreduce(void *sendbuf, void *recvbuf, int count,
-                    MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, newcomm);
-    } else {
-        rc = MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
-    }
-    
-    return rc;
-}
-
-int profuse_isend(void *buf, int count, MPI_Datatype datatype, int dest,
-                  int tag, MPI_Comm comm, MPI_Request *request)
-{
-    int  rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Isend(buf, count, datatype, dest, tag, newcomm, request);
-    } else {
-        rc = MPI_Isend(buf, count, datatype, dest, tag, comm, request);
-    }
-    
-    return rc;
-}
-
-int profuse_irecv(void *buf, int count, MPI_Datatype datatype, int source,
-                  int tag, MPI_Comm comm, MPI_Request *request)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Irecv(buf, count, datatype, source, tag, newcomm, request);
-    } else {
-        rc = MPI_Irecv(buf, count, datatype, source, tag, comm, request);
-    }
-    
-    return rc;
-}
-
-int profuse_barrier(MPI_Comm comm)
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Barrier(newcomm);
-    } else {
-        rc = MPI_Barrier(comm);
-    }
-    
-    return rc;
-}
-
-int profuse_bcast(void *buffer, int count, MPI_Datatype datatype, int root,
-                  MPI_Comm comm )
-{
-    int rc;
-    
-    MPI_Comm_compare(MPI_COMM_WORLD, comm, &rc);
-    if (rc == MPI_IDENT) {
-        rc = MPI_Bcast(buffer, count, datatype, root, newcomm);
-    } else {
-        rc = MPI_Bcast(buffer, count, datatype, root, comm);
-    }
-    
-    return rc;
-}
-
 int profuse_finalize()
 {
     int rc;
@@ -230,6 +159,10 @@ int profuse_finalize()
         printf("time mapping = %f\n", (mapp_end - mapp_begin));
         printf("time test = %f\n", (test_end - test_begin));
     }
+    if (profuse_keyval != MPI_KEYVAL_INVALID) {
+        PMPI_Comm_free_keyval(&profuse_keyval);
+    }
+    vnodes_free();
     rc = PMPI_Finalize();
     
     return rc;
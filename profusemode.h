@@ -12,33 +12,71 @@
 #include <mpi.h>
 
 #include "mapping.h"
+#include "mpipgo.h"
+#include "vnodes.h"
 
-char *mpipgo_graph;
-char *mpipgo_algo;
-int profuse_commsize;
-int profuse_rank;
-double mapp_begin, mapp_end, test_begin, test_end;
+extern char *mpipgo_algo;
+extern char *mpipgo_extrapolate;
+extern char *mpipgo_cache;
+extern char *mpipgo_hierarchy;
+extern char *mpipgo_topo;
+extern char *mpipgo_pins;
+extern char *mpipgo_balance;
+extern int profuse_commsize;
+extern int profuse_rank;
+extern int profuse_worldrank;
+extern int profuse_keyval;
+extern double mapp_begin, mapp_end, test_begin, test_end;
+
+/*
+ * Communicators of application are translated to communicators of mapped
+ * processes: MPI_COMM_WORLD is newcomm, communicators derived from it are
+ * created from newcomm and stay unchanged. Fortran handles are compared
+ * with handle of MPI_COMM_WORLD (profuse_fworld) and passed to Fortran
+ * PMPI functions as is.
+ */
+extern MPI_Comm newcomm;
+extern MPI_Fint profuse_fworld, profuse_fnewcomm;
+
+static inline MPI_Comm profuse_comm(MPI_Comm comm)
+{
+    return (comm == MPI_COMM_WORLD) ? newcomm : comm;
+}
+
+static inline MPI_Fint *profuse_fcomm(MPI_Fint *comm)
+{
+    return (*comm == profuse_fworld) ? &profuse_fnewcomm : comm;
+}
+
+/*
+ * profuse_worldranks: Function returns number of processes of (remote
+ * group of) comm followed by their ranks of MPI_COMM_WORLD of MPI library,
+ * or NULL on error. Array is cached on comm and freed with it.
+ */
+int *profuse_worldranks(MPI_Comm comm);
+
+/*
+ * profuse_send_delay: Function delays message to rank dest of comm of
+ * application if virtual nodes are set with delays.
+ */
+static inline void profuse_send_delay(int dest, int count,
+                                      MPI_Datatype datatype, MPI_Comm comm)
+{
+    int *worldranks, size;
+
+    if (vnodes_shim && dest >= 0
+        && (worldranks = profuse_worldranks(profuse_comm(comm))) != NULL
+        && dest < worldranks[0] && worldranks[dest + 1] != MPI_UNDEFINED) {
+        PMPI_Type_size(datatype, &size);
+        vnodes_delay(profuse_worldrank, worldranks[dest + 1],
+                     (size_t)size * count);
+    }
+}
 
 /*
  * getnodeid: Function returns id of node.
  */
 
 void profuse_init();
-int profuse_comm_size(MPI_Comm comm, int *size);
-int profuse_comm_rank(MPI_Comm comm, int *rank);
-int profuse_abort(MPI_Comm comm, int errcode);
-int profuse_comm_split(MPI_Comm comm, int color, int key, MPI_Comm *newcomm_);
-int profuse_comm_dup(MPI_Comm comm, MPI_Comm *newcomm_);
-int profuse_reduce(void *sendbuf, void *recvbuf, int count,
-                   MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm);
-int profuse_allreduce(void *sendbuf, void *recvbuf, int count,
-                      MPI_Datatype datatype, MPI_Op op, MPI_Comm comm);
-int profuse_isend(void *buf, int count, MPI_Datatype datatype, int dest,
-                  int tag, MPI_Comm comm, MPI_Request *request);
-int profuse_irecv(void *buf, int count, MPI_Datatype datatype, int source,
-                  int tag, MPI_Comm comm, MPI_Request *request);
-int profuse_barrier(MPI_Comm comm);
-int profuse_bcast(void *buffer, int count, MPI_Datatype datatype, int root,
-                  MPI_Comm comm );
 int profuse_finalize();
 #endif /*PROFUSE_MODE_H*/
@@ -4,6 +4,7 @@ struct request {
     int status;
     int size;
     int partner;
+    int direction;
     MPI_Request req;
     request_t *next;
     request_t *prev;
@@ -28,7 +29,7 @@ reqlist_t *reqlist_create()
 }
 
 int reqlist_add(int count, int partner, MPI_Datatype datatype,
-                MPI_Request req, reqlist_t *list)
+                MPI_Request req, int direction, reqlist_t *list)
 {
     request_t *p, *next_p;
     int type_size;
@@ -39,6 +40,7 @@ int reqlist_add(int count, int partner, MPI_Datatype datatype,
     }
     
     p->partner = partner;
+    p->direction = direction;
     
     MPI_Type_size(datatype, &type_size);
     p->status = REQ_NOT_CONFIRMED;
@@ -51,6 +53,7 @@ int reqlist_add(int count, int partner, MPI_Datatype datatype,
     }
     list->head = p;
     list->head->prev = NULL;
+    list->length++;
     return 1;
 }
 
@@ -71,7 +74,8 @@ void reqlist_elem_complate(request_t **elem, commtable_t *table)
 {
     if (*elem != NULL) {
         (*elem)->status = REQ_CONFIRMED;
-        commtable_add_msgsize((*elem)->partner, (*elem)->size, table);
+        commtable_add_msgsize((*elem)->partner, (*elem)->size,
+                              (*elem)->direction, table);
 //        if ((*elem)->prev == NULL && (*elem)->next != NULL) { /*first in list*/
 //            (*elem)->next->prev = NULL;
 //            free(*elem);
@@ -92,12 +96,26 @@ void reqlist_elem_complate(request_t **elem, commtable_t *table)
     }
 }
 
+void reqlist_remove(request_t *elem, reqlist_t *list)
+{
+    if (elem->prev != NULL) {
+        elem->prev->next = elem->next;
+    } else {
+        list->head = elem->next;
+    }
+    if (elem->next != NULL) {
+        elem->next->prev = elem->prev;
+    }
+    list->length--;
+    free(elem);
+}
+
 void reqlist_fill_commtable(reqlist_t *list, commtable_t *table)
 {
     request_t *tmp = list->head;
     
     while (tmp != NULL) {
-        commtable_add_msgsize(tmp->partner, tmp->size, table);
+        commtable_add_msgsize(tmp->partner, tmp->size, tmp->direction, table);
         tmp = tmp->next;
     }
 }
@@ -28,14 +28,20 @@ typedef struct request request_t;
 
 typedef struct reqlist reqlist_t;
 
-int reqlist_add(int count, int partner, 
-                MPI_Datatype datatype, MPI_Request req, reqlist_t *list);
+int reqlist_add(int count, int partner, MPI_Datatype datatype,
+                MPI_Request req, int direction, reqlist_t *list);
 reqlist_t *reqlist_create();
 
 request_t *reqlist_lookup(MPI_Request req, reqlist_t *list);
 
 void reqlist_elem_complate(request_t **elem, commtable_t *table); /*подтверждение*/
 
+/*
+ * reqlist_remove: Function removes element from list and frees it, so
+ * handle of completed request can be reused by new request.
+ */
+void reqlist_remove(request_t *elem, reqlist_t *list);
+
 void reqlist_fill_commtable(reqlist_t *list, commtable_t *table);
 
 void reqlist_print(reqlist_t *list);
@@ -33,7 +33,6 @@ nodes_t *subsystem_init(int *mapp, int commsize, int nparts,
             return NULL;
         }
     }
-    fprintf(stderr, "subsystem stage 1\n");
     for (i = 0; i < commsize; i++) {
         j = subset_nodes[mapp[i]];
         tmp[j].old_proc[tmp[j].nproc] = i;
@@ -0,0 +1,290 @@
+/*
+ * topology.c: Topology of node.
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include <mpi.h>
+
+#include "topology.h"
+
+#ifndef TOPOLOGY_SYSFS
+#define TOPOLOGY_SYSFS "/sys/devices/system/cpu"
+#endif
+
+#define TOPOLOGY_PATH_MAX 256
+
+int topology_level = TOPOLOGY_NONE;
+int topology_bind_mode = TOPOLOGY_BIND_NONE;
+
+/* CPU of bound process */
+static int topology_cpu = -1;
+
+typedef struct topology_cpukey topology_cpukey_t;
+struct topology_cpukey {
+    int key[5];                 /* Socket, NUMA node, L3, core, CPU */
+};
+
+static int topology_read_int(const char *path)
+{
+    FILE *f;
+    int v;
+
+    if ((f = fopen(path, "r")) == NULL) {
+        return -1;
+    }
+    if (fscanf(f, "%d", &v) != 1) {
+        v = -1;
+    }
+    fclose(f);
+
+    return v;
+}
+
+/* NUMA node of cpu is link cpuN/nodeM */
+static int topology_cpu_numa(int cpu)
+{
+    char path[TOPOLOGY_PATH_MAX];
+    struct dirent *e;
+    DIR *d;
+    int node = -1;
+
+    snprintf(path, sizeof(path), TOPOLOGY_SYSFS "/cpu%d", cpu);
+    if ((d = opendir(path)) == NULL) {
+        return -1;
+    }
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, "node", 4) == 0
+            && sscanf(e->d_name + 4, "%d", &node) == 1) {
+            break;
+        }
+    }
+    closedir(d);
+
+    return node;
+}
+
+/*
+ * Cache of level 3 is identified by id or, on older kernels, by first CPU
+ * sharing it.
+ */
+static int topology_cpu_l3(int cpu)
+{
+    char path[TOPOLOGY_PATH_MAX];
+    FILE *f;
+    int i, id;
+
+    for (i = 0; ; i++) {
+        snprintf(path, sizeof(path),
+                 TOPOLOGY_SYSFS "/cpu%d/cache/index%d/level", cpu, i);
+        if ((id = topology_read_int(path)) < 0) {
+            return -1;
+        }
+        if (id == 3) {
+            break;
+        }
+    }
+    snprintf(path, sizeof(path), TOPOLOGY_SYSFS "/cpu%d/cache/index%d/id",
+             cpu, i);
+    if ((id = topology_read_int(path)) >= 0) {
+        return id;
+    }
+    snprintf(path, sizeof(path),
+             TOPOLOGY_SYSFS "/cpu%d/cache/index%d/shared_cpu_list", cpu, i);
+    if ((f = fopen(path, "r")) == NULL) {
+        return -1;
+    }
+    if (fscanf(f, "%d", &id) != 1) {
+        id = -1;
+    }
+    fclose(f);
+
+    return id;
+}
+
+int topology_init(const char *level)
+{
+    if (level == NULL) {
+        topology_level = TOPOLOGY_NONE;
+    } else if (strcmp(level, "socket") == 0) {
+        topology_level = TOPOLOGY_SOCKET;
+    } else if (strcmp(level, "numa") == 0) {
+        topology_level = TOPOLOGY_NUMA;
+    } else if (strcmp(level, "l3") == 0) {
+        topology_level = TOPOLOGY_L3;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int topology_cpukey_cmp(const void *a, const void *b)
+{
+    const topology_cpukey_t *x = a, *y = b;
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        if (x->key[i] != y->key[i]) {
+            return (x->key[i] < y->key[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+int topology_bind_init(const char *bind)
+{
+    if (bind == NULL) {
+        topology_bind_mode = TOPOLOGY_BIND_NONE;
+        return 0;
+    } else if (strcmp(bind, "core") == 0) {
+        topology_bind_mode = TOPOLOGY_BIND_CORE;
+    } else if (strcmp(bind, "domain") == 0) {
+        topology_bind_mode = TOPOLOGY_BIND_DOMAIN;
+    } else {
+        return -1;
+    }
+    if (topology_level == TOPOLOGY_NONE) {
+        topology_level = TOPOLOGY_SOCKET;
+    }
+
+    return 0;
+}
+
+/* topology_prefer_node: Memory is preferably allocated on NUMA node. */
+static void topology_prefer_node(int node)
+{
+#ifdef SYS_set_mempolicy
+    unsigned long mask[16];
+    int bits = 8 * sizeof(unsigned long);
+
+    if (node < 0 || node >= 16 * bits) {
+        return;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[node / bits] = 1UL << (node % bits);
+    syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 16 * bits);
+#endif
+}
+
+int topology_bind()
+{
+    MPI_Comm nodecomm;
+    cpu_set_t mask, nodemask;
+    topology_cpukey_t *cpus;
+    char path[TOPOLOGY_PATH_MAX];
+    int rank, noderank, nodesize, ncpus, i, j, domain;
+
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#if MPI_VERSION >= 3
+    PMPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                         MPI_INFO_NULL, &nodecomm);
+#else
+    PMPI_Comm_split(MPI_COMM_WORLD, 0, rank, &nodecomm);
+#endif
+    PMPI_Comm_rank(nodecomm, &noderank);
+    PMPI_Comm_size(nodecomm, &nodesize);
+
+    /* CPUs of node are CPUs given to its processes by launcher */
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+        CPU_ZERO(&mask);
+    }
+    PMPI_Allreduce(&mask, &nodemask, sizeof(mask), MPI_BYTE, MPI_BOR,
+                   nodecomm);
+    PMPI_Comm_free(&nodecomm);
+
+    if ((ncpus = CPU_COUNT(&nodemask)) == 0) {
+        return -1;
+    }
+    if ((cpus = malloc(sizeof(*cpus) * ncpus)) == NULL) {
+        return -1;
+    }
+    for (i = 0, j = 0; i < CPU_SETSIZE && j < ncpus; i++) {
+        if (!CPU_ISSET(i, &nodemask)) {
+            continue;
+        }
+        snprintf(path, sizeof(path),
+                 TOPOLOGY_SYSFS "/cpu%d/topology/core_id", i);
+        cpus[j].key[0] = topology_cpu_domain(i, TOPOLOGY_SOCKET);
+        cpus[j].key[1] = topology_cpu_domain(i, TOPOLOGY_NUMA);
+        cpus[j].key[2] = topology_cpu_domain(i, TOPOLOGY_L3);
+        cpus[j].key[3] = topology_read_int(path);
+        cpus[j].key[4] = i;
+        j++;
+    }
+    qsort(cpus, ncpus, sizeof(*cpus), topology_cpukey_cmp);
+
+    topology_cpu = cpus[(int)((long)noderank * ncpus / nodesize)].key[4];
+    CPU_ZERO(&mask);
+    if (topology_bind_mode == TOPOLOGY_BIND_CORE) {
+        CPU_SET(topology_cpu, &mask);
+    } else {
+        domain = topology_cpu_domain(topology_cpu, topology_level);
+        for (i = 0; i < ncpus; i++) {
+            if (topology_cpu_domain(cpus[i].key[4], topology_level)
+                == domain) {
+                CPU_SET(cpus[i].key[4], &mask);
+            }
+        }
+    }
+    free(cpus);
+
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+        return -1;
+    }
+    topology_prefer_node(topology_cpu_domain(topology_cpu, TOPOLOGY_NUMA));
+
+    return 0;
+}
+
+int topology_cpu_domain(int cpu, int level)
+{
+    char path[TOPOLOGY_PATH_MAX];
+
+    switch (level) {
+    case TOPOLOGY_SOCKET:
+        snprintf(path, sizeof(path),
+                 TOPOLOGY_SYSFS "/cpu%d/topology/physical_package_id", cpu);
+        return topology_read_int(path);
+    case TOPOLOGY_NUMA:
+        return topology_cpu_numa(cpu);
+    case TOPOLOGY_L3:
+        return topology_cpu_l3(cpu);
+    }
+
+    return -1;
+}
+
+int topology_domain()
+{
+    cpu_set_t mask;
+    int i, d, domain = -1;
+
+    if (topology_cpu >= 0) {
+        return topology_cpu_domain(topology_cpu, topology_level);
+    }
+    /* CPU of unbound process may change, so all CPUs it may run on count */
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+        return -1;
+    }
+    for (i = 0; i < CPU_SETSIZE; i++) {
+        if (!CPU_ISSET(i, &mask)) {
+            continue;
+        }
+        if ((d = topology_cpu_domain(i, topology_level)) < 0
+            || (domain >= 0 && d != domain)) {
+            return -1;
+        }
+        domain = d;
+    }
+
+    return domain;
+}
@@ -0,0 +1,66 @@
+/*
+ * topology.h: Topology of node.
+ *
+ * Domains of second level of mapping (MPIPGO_LEVEL2=socket|numa|l3) are
+ * read from /sys: processes are grouped by domain of CPUs of their affinity
+ * mask, and mapping partitions each node part between groups of node. If
+ * mask of any process spans several domains, second level is skipped.
+ *
+ * MPIPGO_BIND=core|domain binds processes before mapping: CPUs of node are
+ * ordered by socket, NUMA node, L3 cache and core, and process with local
+ * rank k of n gets CPU k * ncpus / n (core) or all CPUs of its domain
+ * (domain). Domains of second level are domains of these CPUs, so ranks
+ * which communicate heavily share socket or cache. Memory is preferably
+ * allocated on NUMA node of the CPU.
+ */
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+    TOPOLOGY_NONE = 0,
+    TOPOLOGY_SOCKET = 1,
+    TOPOLOGY_NUMA = 2,
+    TOPOLOGY_L3 = 3
+};
+
+enum {
+    TOPOLOGY_BIND_NONE = 0,
+    TOPOLOGY_BIND_CORE = 1,
+    TOPOLOGY_BIND_DOMAIN = 2
+};
+
+extern int topology_level;
+extern int topology_bind_mode;
+
+/*
+ * topology_init: Function sets level by name (socket, numa, l3; NULL is
+ * none). Returns 0 on success and -1 for unknown name.
+ */
+int topology_init(const char *level);
+
+/*
+ * topology_bind_init: Function sets binding by name (core, domain; NULL is
+ * none). Level of domains defaults to socket. Returns 0 on success and -1
+ * for unknown name.
+ */
+int topology_bind_init(const char *bind);
+
+/*
+ * topology_bind: Function binds calling process. Collective over
+ * MPI_COMM_WORLD. Returns 0 on success and -1 on error.
+ */
+int topology_bind();
+
+/* topology_cpu_domain: Function returns domain of cpu or -1. */
+int topology_cpu_domain(int cpu, int level);
+
+/*
+ * topology_domain: Function returns domain of CPUs the calling process may
+ * run on, or -1 if it is unknown or they span several domains.
+ */
+int topology_domain();
+
+#endif /*TOPOLOGY_H*/
@@ -0,0 +1,95 @@
+/*
+ * vnodes.c: Virtual nodes.
+ */
+
+#include <mpi.h>
+
+#include "vnodes.h"
+
+int *vnodes_map = NULL;
+int vnodes_shim = 0;
+
+static double vnodes_lat = 0.0;
+static double vnodes_bw = 0.0;
+
+static int vnodes_read(const char *filename, int commsize)
+{
+    FILE *f;
+    int i;
+
+    if ((f = fopen(filename, "r")) == NULL) {
+        fprintf(stderr, "MPIPGO_NODEFILE: can not open %s\n", filename);
+        return -1;
+    }
+    for (i = 0; i < commsize; i++) {
+        if (fscanf(f, "%d", &vnodes_map[i]) != 1 || vnodes_map[i] < 0) {
+            fprintf(stderr, "MPIPGO_NODEFILE: no node of rank %d\n", i);
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+
+    return 0;
+}
+
+int vnodes_init(int commsize)
+{
+    char *ppn, *nodefile, *lat, *bw;
+    int i, n;
+
+    ppn = getenv("MPIPGO_PPN");
+    nodefile = getenv("MPIPGO_NODEFILE");
+    if (ppn == NULL && nodefile == NULL) {
+        return 1;
+    }
+
+    if ((vnodes_map = malloc(sizeof(int) * commsize)) == NULL) {
+        return -1;
+    }
+    if (ppn != NULL) {
+        if ((n = atoi(ppn)) <= 0) {
+            fprintf(stderr, "MPIPGO_PPN must be positive\n");
+            vnodes_free();
+            return -1;
+        }
+        for (i = 0; i < commsize; i++) {
+            vnodes_map[i] = i / n;
+        }
+    } else if (vnodes_read(nodefile, commsize) != 0) {
+        vnodes_free();
+        return -1;
+    }
+
+    if ((lat = getenv("MPIPGO_VLAT")) != NULL) {
+        vnodes_lat = atof(lat) * 1e-6;
+    }
+    if ((bw = getenv("MPIPGO_VBW")) != NULL) {
+        vnodes_bw = atof(bw) * 1e6;
+    }
+    vnodes_shim = (vnodes_lat > 0.0 || vnodes_bw > 0.0);
+
+    return 0;
+}
+
+void vnodes_delay(int src, int dst, size_t size)
+{
+    double t;
+
+    if (vnodes_map[src] == vnodes_map[dst]) {
+        return;
+    }
+    t = vnodes_lat;
+    if (vnodes_bw > 0.0) {
+        t += (double)size / vnodes_bw;
+    }
+    for (t += PMPI_Wtime(); PMPI_Wtime() < t; )
+        ;
+}
+
+void vnodes_free()
+{
+    free(vnodes_map);
+    vnodes_map = NULL;
+    vnodes_shim = 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * vnodes.h: Virtual nodes.
+ *
+ * Processes are assigned to virtual nodes instead of physical ones:
+ * MPIPGO_PPN=<n> puts ranks n * k .. n * k + n - 1 to node k,
+ * MPIPGO_NODEFILE=<file> lists node of every rank (one integer per rank).
+ * Messages between virtual nodes can be delayed by MPIPGO_VLAT
+ * (microseconds) and MPIPGO_VBW (MB/s), so mappings can be compared on
+ * one host.
+ */
+#ifndef VNODES_H
+#define VNODES_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+extern int *vnodes_map;
+extern int vnodes_shim;
+
+/*
+ * vnodes_init: Function reads virtual nodes of commsize ranks. Returns 0 if
+ * virtual nodes are set, 1 if they are not set and -1 on error.
+ */
+int vnodes_init(int commsize);
+
+/*
+ * vnodes_delay: Function waits for latency and transfer time of message of
+ * size bytes from rank src to rank dst if ranks are on different virtual
+ * nodes.
+ */
+void vnodes_delay(int src, int dst, size_t size);
+
+void vnodes_free();
+
+#endif /*VNODES_H*/
@@ -0,0 +1,390 @@
+/*
+ * wrappers.c: Fortran wrappers of MPI functions.
+ *
+ * Wrappers dispatch calls by mode selected at MPI_Init (see mpipgo.h):
+ * profgen registers messages, profuse substitutes MPI_COMM_WORLD by
+ * mapped communicator, off passes calls to PMPI. Functions which only
+ * translate communicator are declared in wrappers_f.def and call Fortran
+ * PMPI functions with handles of application.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <mpi.h>
+
+#include "mpipgo.h"
+#include "profgenmode.h"
+#include "profusemode.h"
+
+/* Fortran status is array of MPI_Fint of size of C status */
+#define F_STATUS_SIZE (sizeof(MPI_Status) / sizeof(MPI_Fint))
+
+static inline MPI_Fint *wrap_fcomm(MPI_Fint *comm)
+{
+    return (mpipgo_mode == MPIPGO_MODE_PROFUSE) ? profuse_fcomm(comm) : comm;
+}
+
+/* Prototypes of Fortran PMPI functions */
+#define FWRAP(name, params, args) void pmpi_##name##_ params;
+#define FHAND(name, params, args) void pmpi_##name##_ params;
+#include "wrappers_f.def"
+#undef FWRAP
+#undef FHAND
+
+/* Prototypes of Fortran PMPI functions of completion of requests */
+void pmpi_test_(MPI_Fint *request, MPI_Fint *flag, MPI_Fint *status,
+                MPI_Fint *ierr);
+void pmpi_testany_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                   MPI_Fint *index, MPI_Fint *flag, MPI_Fint *status,
+                   MPI_Fint *ierr);
+void pmpi_testall_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                   MPI_Fint *flag, MPI_Fint array_of_statuses[],
+                   MPI_Fint *ierr);
+void pmpi_testsome_(MPI_Fint *incount, MPI_Fint array_of_requests[],
+                    MPI_Fint *outcount, MPI_Fint array_of_indices[],
+                    MPI_Fint array_of_statuses[], MPI_Fint *ierr);
+void pmpi_waitany_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                   MPI_Fint *index, MPI_Fint *status, MPI_Fint *ierr);
+void pmpi_waitsome_(MPI_Fint *incount, MPI_Fint array_of_requests[],
+                    MPI_Fint *outcount, MPI_Fint array_of_indices[],
+                    MPI_Fint array_of_statuses[], MPI_Fint *ierr);
+void pmpi_request_free_(MPI_Fint *request, MPI_Fint *ierr);
+
+#define FCOMM(comm) wrap_fcomm(comm)
+#define FWRAP(name, params, args)       \
+    void mpi_##name##_ params           \
+    {                                   \
+        double begin = profgen_enter(); \
+        pmpi_##name##_ args;            \
+        profgen_leave(begin);           \
+    }
+#define FHAND(name, params, args)
+#include "wrappers_f.def"
+#undef FWRAP
+#undef FHAND
+
+void mpi_init_(MPI_Fint *ierr)
+{
+    int rc;
+
+    if ((rc = PMPI_Init(NULL, NULL)) == MPI_SUCCESS) {
+        mpipgo_init();
+    }
+    *ierr = (MPI_Fint)rc;
+}
+
+void mpi_init_thread_(MPI_Fint *required, MPI_Fint *provided, MPI_Fint *ierr)
+{
+    int rc, prov;
+
+    if ((rc = PMPI_Init_thread(NULL, NULL, (int)*required, &prov))
+        == MPI_SUCCESS) {
+        mpipgo_init();
+    }
+    *provided = (MPI_Fint)prov;
+    *ierr = (MPI_Fint)rc;
+}
+
+/* ===================================================== */
+
+static inline void wrap_send_delay(MPI_Fint *dest, MPI_Fint *count,
+                                   MPI_Fint *datatype, MPI_Fint *comm)
+{
+    if (mpipgo_mode == MPIPGO_MODE_PROFUSE && vnodes_shim) {
+        profuse_send_delay((int)*dest, (int)*count, MPI_Type_f2c(*datatype),
+                           MPI_Comm_f2c(*comm));
+    }
+}
+
+void mpi_send_(void *buf, MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *dest,
+               MPI_Fint *tag, MPI_Fint *comm, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+
+    wrap_send_delay(dest, count, datatype, comm);
+    pmpi_send_(buf, count, datatype, dest, tag, FCOMM(comm), ierr);
+    profgen_leave(begin);
+}
+
+void mpi_ssend_(void *buf, MPI_Fint *count, MPI_Fint *datatype,
+                MPI_Fint *dest, MPI_Fint *tag, MPI_Fint *comm, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+
+    wrap_send_delay(dest, count, datatype, comm);
+    pmpi_ssend_(buf, count, datatype, dest, tag, FCOMM(comm), ierr);
+    profgen_leave(begin);
+}
+
+void mpi_sendrecv_(void *sendbuf, MPI_Fint *sendcount, MPI_Fint *sendtype,
+                   MPI_Fint *dest, MPI_Fint *sendtag, void *recvbuf,
+                   MPI_Fint *recvcount, MPI_Fint *recvtype, MPI_Fint *source,
+                   MPI_Fint *recvtag, MPI_Fint *comm, MPI_Fint *status,
+                   MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+
+    wrap_send_delay(dest, sendcount, sendtype, comm);
+    pmpi_sendrecv_(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf,
+                   recvcount, recvtype, source, recvtag, FCOMM(comm), status,
+                   ierr);
+    profgen_leave(begin);
+}
+
+void mpi_isend_(void *buf, MPI_Fint *count, MPI_Fint *datatype, MPI_Fint *dest,
+                MPI_Fint *tag, MPI_Fint *comm, MPI_Fint *request,
+                MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    int rc;
+    MPI_Request tmp_request;
+
+    if (mpipgo_mode != MPIPGO_MODE_PROFGEN) {
+        wrap_send_delay(dest, count, datatype, comm);
+        pmpi_isend_(buf, count, datatype, dest, tag, FCOMM(comm), request,
+                    ierr);
+        return;
+    }
+
+    rc = PMPI_Isend(buf, (int)*count, MPI_Type_f2c(*datatype), (int)*dest,
+                    (int)*tag, MPI_Comm_f2c(*comm), &tmp_request);
+    if (rc == MPI_SUCCESS) {
+        profgenmode_reg_pt2pt((int)*count, (int)*dest,
+                              MPI_Type_f2c(*datatype), tmp_request,
+                              COMMTABLE_SEND);
+    }
+    *request = MPI_Request_c2f(tmp_request);
+    *ierr = (MPI_Fint)rc;
+    profgen_leave(begin);
+}
+
+void mpi_irecv_(void *buf, MPI_Fint *count, MPI_Fint *datatype,
+                MPI_Fint *source, MPI_Fint *tag, MPI_Fint *comm,
+                MPI_Fint *request, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    int rc;
+    MPI_Request tmp_request;
+
+    if (mpipgo_mode != MPIPGO_MODE_PROFGEN) {
+        pmpi_irecv_(buf, count, datatype, source, tag, FCOMM(comm), request,
+                    ierr);
+        return;
+    }
+
+    rc = PMPI_Irecv(buf, (int)*count, MPI_Type_f2c(*datatype),
+                    (int)*source, (int)*tag, MPI_Comm_f2c(*comm),
+                    &tmp_request);
+    if (rc == MPI_SUCCESS) {
+        profgenmode_reg_pt2pt((int)*count, (int)*source,
+                              MPI_Type_f2c(*datatype), tmp_request,
+                              COMMTABLE_RECV);
+    }
+    *request = MPI_Request_c2f(tmp_request);
+    *ierr = (MPI_Fint)rc;
+    profgen_leave(begin);
+}
+
+void mpi_wait_(MPI_Fint *request, MPI_Fint *status, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request tmp_request;
+    MPI_Status tmp_status;
+    int rc;
+
+    MPI_Status_f2c(status, &tmp_status);
+    tmp_request = MPI_Request_f2c(*request);
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_one(tmp_request);
+    }
+
+    rc = PMPI_Wait(&tmp_request, &tmp_status);
+
+    *request = MPI_Request_c2f(tmp_request);
+    MPI_Status_c2f(&tmp_status, status);
+
+    *ierr = (MPI_Fint)rc;
+    profgen_leave(begin);
+}
+
+void mpi_waitall_(MPI_Fint *count, MPI_Fint array_of_request[],
+                  MPI_Fint array_of_status[], MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *tmp_request;
+    MPI_Status *tmp_status;
+    int rc, i;
+
+    tmp_status = malloc(sizeof(MPI_Status) * ((int)*count));
+    tmp_request = malloc(sizeof(MPI_Request) * ((int)*count));
+
+    for (i = 0; i < (int)*count; i++) {
+        MPI_Status_f2c(&array_of_status[i * F_STATUS_SIZE],
+                       &tmp_status[i]);
+        tmp_request[i] = MPI_Request_f2c(array_of_request[i]);
+    }
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_all(tmp_request, (int)*count);
+    }
+
+    rc = PMPI_Waitall((int)*count, tmp_request, tmp_status);
+
+    for (i = 0; i < (int)*count; i++) {
+        array_of_request[i] = MPI_Request_c2f(tmp_request[i]);
+        PMPI_Status_c2f(&tmp_status[i],
+                        &array_of_status[i * F_STATUS_SIZE]);
+    }
+
+    free(tmp_status);
+    free(tmp_request);
+
+    *ierr = (MPI_Fint)rc;
+    profgen_leave(begin);
+}
+
+/*
+ * Completion of requests: time of polling is not compute time. Completed
+ * requests are set to MPI_REQUEST_NULL, so handles are copied before the
+ * call and requests reported as completed are registered after it.
+ * Fortran indices are 1-based.
+ */
+static MPI_Request *wrap_save_frequests(MPI_Fint *requests, int count)
+{
+    MPI_Request *saved;
+    int i;
+
+    if (mpipgo_mode != MPIPGO_MODE_PROFGEN || count <= 0) {
+        return NULL;
+    }
+    saved = profgenmode_reqbuf(count);
+    for (i = 0; i < count; i++) {
+        saved[i] = MPI_Request_f2c(requests[i]);
+    }
+
+    return saved;
+}
+
+static void wrap_complete_findices(MPI_Request *saved, MPI_Fint *indices,
+                                   int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        profgenmode_complete_pt2pt_one(saved[indices[i] - 1]);
+    }
+}
+
+void mpi_test_(MPI_Fint *request, MPI_Fint *flag, MPI_Fint *status,
+               MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request saved = MPI_Request_f2c(*request);
+
+    pmpi_test_(request, flag, status, ierr);
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN && *ierr == MPI_SUCCESS
+        && *flag) {
+        profgenmode_complete_pt2pt_one(saved);
+    }
+    profgen_leave(begin);
+}
+
+void mpi_testany_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                  MPI_Fint *index, MPI_Fint *flag, MPI_Fint *status,
+                  MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_frequests(array_of_requests, (int)*count);
+
+    pmpi_testany_(count, array_of_requests, index, flag, status, ierr);
+    if (saved != NULL && *ierr == MPI_SUCCESS && *flag
+        && *index != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_one(saved[*index - 1]);
+    }
+    profgen_leave(begin);
+}
+
+void mpi_testall_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                  MPI_Fint *flag, MPI_Fint array_of_statuses[],
+                  MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_frequests(array_of_requests, (int)*count);
+
+    pmpi_testall_(count, array_of_requests, flag, array_of_statuses, ierr);
+    if (saved != NULL && *ierr == MPI_SUCCESS && *flag) {
+        profgenmode_complete_pt2pt_all(saved, (int)*count);
+    }
+    profgen_leave(begin);
+}
+
+void mpi_testsome_(MPI_Fint *incount, MPI_Fint array_of_requests[],
+                   MPI_Fint *outcount, MPI_Fint array_of_indices[],
+                   MPI_Fint array_of_statuses[], MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_frequests(array_of_requests,
+                                             (int)*incount);
+
+    pmpi_testsome_(incount, array_of_requests, outcount, array_of_indices,
+                   array_of_statuses, ierr);
+    if (saved != NULL && *ierr == MPI_SUCCESS
+        && *outcount != MPI_UNDEFINED) {
+        wrap_complete_findices(saved, array_of_indices, (int)*outcount);
+    }
+    profgen_leave(begin);
+}
+
+void mpi_waitany_(MPI_Fint *count, MPI_Fint array_of_requests[],
+                  MPI_Fint *index, MPI_Fint *status, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_frequests(array_of_requests, (int)*count);
+
+    pmpi_waitany_(count, array_of_requests, index, status, ierr);
+    if (saved != NULL && *ierr == MPI_SUCCESS && *index != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_one(saved[*index - 1]);
+    }
+    profgen_leave(begin);
+}
+
+void mpi_waitsome_(MPI_Fint *incount, MPI_Fint array_of_requests[],
+                   MPI_Fint *outcount, MPI_Fint array_of_indices[],
+                   MPI_Fint array_of_statuses[], MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_frequests(array_of_requests,
+                                             (int)*incount);
+
+    pmpi_waitsome_(incount, array_of_requests, outcount, array_of_indices,
+                   array_of_statuses, ierr);
+    if (saved != NULL && *ierr == MPI_SUCCESS
+        && *outcount != MPI_UNDEFINED) {
+        wrap_complete_findices(saved, array_of_indices, (int)*outcount);
+    }
+    profgen_leave(begin);
+}
+
+/* Freed request still completes: its message is registered */
+void mpi_request_free_(MPI_Fint *request, MPI_Fint *ierr)
+{
+    double begin = profgen_enter();
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_one(MPI_Request_f2c(*request));
+    }
+    pmpi_request_free_(request, ierr);
+    profgen_leave(begin);
+}
+
+void mpi_finalize_(MPI_Fint *ierr)
+{
+    *ierr = (MPI_Fint)mpipgo_finalize();
+}
@@ -0,0 +1,314 @@
+/*
+ * wrappers_c.c: C wrappers of MPI functions.
+ *
+ * In profuse mode communicators of application are translated to
+ * communicators of mapped processes (see profusemode.h), so C programs
+ * run on the remapped MPI_COMM_WORLD. Functions which only translate
+ * communicator are declared in wrappers_c.def.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mpi.h>
+
+#include "mpipgo.h"
+#include "profgenmode.h"
+#include "profusemode.h"
+
+static inline MPI_Comm wrap_comm(MPI_Comm comm)
+{
+    return (mpipgo_mode == MPIPGO_MODE_PROFUSE) ? profuse_comm(comm) : comm;
+}
+
+#define COMM(comm) wrap_comm(comm)
+#define WRAP(name, params, args)         \
+    int MPI_##name params                \
+    {                                    \
+        double begin = profgen_enter();  \
+        int rc = PMPI_##name args;       \
+        profgen_leave(begin);            \
+        return rc;                       \
+    }
+#include "wrappers_c.def"
+#undef WRAP
+#undef COMM
+
+int MPI_Init(int *argc, char ***argv)
+{
+    int rc;
+
+    if ((rc = PMPI_Init(argc, argv)) == MPI_SUCCESS) {
+        mpipgo_init();
+    }
+
+    return rc;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided)
+{
+    int rc;
+
+    if ((rc = PMPI_Init_thread(argc, argv, required, provided))
+        == MPI_SUCCESS) {
+        mpipgo_init();
+    }
+
+    return rc;
+}
+
+int MPI_Finalize()
+{
+    return mpipgo_finalize();
+}
+
+/* ===================================================== */
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest,
+             int tag, MPI_Comm comm)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        profuse_send_delay(dest, count, datatype, comm);
+    }
+    rc = PMPI_Send(buf, count, datatype, dest, tag, wrap_comm(comm));
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        profuse_send_delay(dest, count, datatype, comm);
+    }
+    rc = PMPI_Isend(buf, count, datatype, dest, tag, wrap_comm(comm),
+                    request);
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN && rc == MPI_SUCCESS) {
+        profgenmode_reg_pt2pt(count, dest, datatype, *request,
+                              COMMTABLE_SEND);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Ssend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        profuse_send_delay(dest, count, datatype, comm);
+    }
+    rc = PMPI_Ssend(buf, count, datatype, dest, tag, wrap_comm(comm));
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 int dest, int sendtag, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int source, int recvtag,
+                 MPI_Comm comm, MPI_Status *status)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFUSE) {
+        profuse_send_delay(dest, sendcount, sendtype, comm);
+    }
+    rc = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf,
+                       recvcount, recvtype, source, recvtag, wrap_comm(comm),
+                       status);
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype datatype, int source,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    rc = PMPI_Irecv(buf, count, datatype, source, tag, wrap_comm(comm),
+                    request);
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN && rc == MPI_SUCCESS) {
+        profgenmode_reg_pt2pt(count, source, datatype, *request,
+                              COMMTABLE_RECV);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_one(*request);
+    }
+    rc = PMPI_Wait(request, status);
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[],
+                MPI_Status array_of_statuses[])
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_all(array_of_requests, count);
+    }
+    rc = PMPI_Waitall(count, array_of_requests, array_of_statuses);
+    profgen_leave(begin);
+
+    return rc;
+}
+
+/*
+ * Completion of requests: time of polling is not compute time. Completed
+ * requests are set to MPI_REQUEST_NULL, so handles are copied before the
+ * call and requests reported as completed are registered after it.
+ */
+static MPI_Request *wrap_save_requests(MPI_Request *requests, int count)
+{
+    MPI_Request *saved;
+
+    if (mpipgo_mode != MPIPGO_MODE_PROFGEN || count <= 0) {
+        return NULL;
+    }
+    saved = profgenmode_reqbuf(count);
+    memcpy(saved, requests, sizeof(MPI_Request) * count);
+
+    return saved;
+}
+
+int MPI_Test(MPI_Request *request, int *flag, MPI_Status *status)
+{
+    double begin = profgen_enter();
+    MPI_Request saved = *request;
+    int rc;
+
+    rc = PMPI_Test(request, flag, status);
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN && rc == MPI_SUCCESS && *flag) {
+        profgenmode_complete_pt2pt_one(saved);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Testany(int count, MPI_Request array_of_requests[], int *index,
+                int *flag, MPI_Status *status)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_requests(array_of_requests, count);
+    int rc;
+
+    rc = PMPI_Testany(count, array_of_requests, index, flag, status);
+    if (saved != NULL && rc == MPI_SUCCESS && *flag
+        && *index != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_one(saved[*index]);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Testall(int count, MPI_Request array_of_requests[], int *flag,
+                MPI_Status array_of_statuses[])
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_requests(array_of_requests, count);
+    int rc;
+
+    rc = PMPI_Testall(count, array_of_requests, flag, array_of_statuses);
+    if (saved != NULL && rc == MPI_SUCCESS && *flag) {
+        profgenmode_complete_pt2pt_all(saved, count);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Testsome(int incount, MPI_Request array_of_requests[],
+                 int *outcount, int array_of_indices[],
+                 MPI_Status array_of_statuses[])
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_requests(array_of_requests, incount);
+    int rc;
+
+    rc = PMPI_Testsome(incount, array_of_requests, outcount,
+                       array_of_indices, array_of_statuses);
+    if (saved != NULL && rc == MPI_SUCCESS && *outcount != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_some(saved, array_of_indices, *outcount);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Waitany(int count, MPI_Request array_of_requests[], int *index,
+                MPI_Status *status)
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_requests(array_of_requests, count);
+    int rc;
+
+    rc = PMPI_Waitany(count, array_of_requests, index, status);
+    if (saved != NULL && rc == MPI_SUCCESS && *index != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_one(saved[*index]);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+int MPI_Waitsome(int incount, MPI_Request array_of_requests[],
+                 int *outcount, int array_of_indices[],
+                 MPI_Status array_of_statuses[])
+{
+    double begin = profgen_enter();
+    MPI_Request *saved = wrap_save_requests(array_of_requests, incount);
+    int rc;
+
+    rc = PMPI_Waitsome(incount, array_of_requests, outcount,
+                       array_of_indices, array_of_statuses);
+    if (saved != NULL && rc == MPI_SUCCESS && *outcount != MPI_UNDEFINED) {
+        profgenmode_complete_pt2pt_some(saved, array_of_indices, *outcount);
+    }
+    profgen_leave(begin);
+
+    return rc;
+}
+
+/* Freed request still completes: its message is registered */
+int MPI_Request_free(MPI_Request *request)
+{
+    double begin = profgen_enter();
+    int rc;
+
+    if (mpipgo_mode == MPIPGO_MODE_PROFGEN) {
+        profgenmode_complete_pt2pt_one(*request);
+    }
+    rc = PMPI_Request_free(request);
+    profgen_leave(begin);
+
+    return rc;
+}